@@ -2,6 +2,8 @@
 #define FILELOGGER_H
 
 #include <fstream>
+#include <string>
+#include <mutex>
 
 namespace MazeLog {
 
@@ -13,17 +15,16 @@ namespace MazeLog {
 
 
         // ctor 
-        FileLogger() {}
+        FileLogger() : numWarnings(0U), numErrors(0U) {}
 
-        // Initializier 
-        void initFile()
+        // Initializier.  Every Graph that owns its logger needs its own file name
+        void initFile(const std::string& fname = "maze_log.txt")
         {
 
             numWarnings = 0U;
             numErrors = 0U;
 
             const char * engine_version = "1.1";
-            const char * fname = "maze_log.txt";
 
             myFile.open(fname);
             if (myFile.is_open()) {
@@ -88,6 +89,15 @@ namespace MazeLog {
             return logger;
         }
 
+        // One whole line under a lock, so Graphs on different threads can share a logger
+        void log(const e_logType l_type, const std::string& text)
+        {
+            std::lock_guard<std::mutex> lock(logMutex);
+            *this << l_type << text;
+        }
+
+        bool isOpen() const { return myFile.is_open(); }
+
         // Make it Non Copyable
         FileLogger(const FileLogger &) = delete;
         FileLogger &operator= (const FileLogger &) = delete;
@@ -95,6 +105,7 @@ namespace MazeLog {
     private:
 
         std::ofstream           myFile;
+        std::mutex              logMutex;
 
         unsigned int            numWarnings;
         unsigned int            numErrors;
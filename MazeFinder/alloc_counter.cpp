@@ -0,0 +1,84 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    std::atomic<unsigned long long> allocCount(0);
+    std::atomic<unsigned long long> allocBytes(0);
+
+    void * countedAlloc(std::size_t size)
+    {
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+}  // namespace
+
+AllocCounter::Snapshot AllocCounter::now()
+{
+    Snapshot snapshot;
+    snapshot.count = allocCount.load(std::memory_order_relaxed);
+    snapshot.bytes = allocBytes.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+// Global replacements.  Every form of delete must match so nothing frees through a different allocator
+void * operator new(std::size_t size)
+{
+    void * ptr = countedAlloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new[](std::size_t size)
+{
+    void * ptr = countedAlloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,18 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// Counts every call to the global operator new (replaced in alloc_counter.cpp).
+// Always on.  It is one relaxed atomic add per allocation, which is noise next to malloc itself.
+namespace AllocCounter {
+
+    struct Snapshot
+    {
+        unsigned long long count; // Calls to operator new / new[]
+        unsigned long long bytes; // Bytes requested
+    };
+
+    Snapshot now();
+
+}  // namespace
+
+#endif // !ALLOC_COUNTER_H
@@ -0,0 +1,74 @@
+#include "arena.h"
+
+#include <new>
+#include <algorithm>
+
+Arena::Arena(std::size_t blockSize)
+    : blockSize(blockSize), used(0), total(0)
+{
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+void Arena::addBlock(std::size_t minimum)
+{
+    Block block;
+    block.size = std::max(blockSize, minimum);
+    block.data = static_cast<char *>(::operator new(block.size));
+    blocks.push_back(block);
+    used = 0;
+}
+
+void * Arena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (bytes == 0)
+        bytes = 1;
+
+    if (!blocks.empty()) {
+        Block& block = blocks.back();
+        std::size_t offset = (used + alignment - 1) / alignment * alignment;
+        if (offset + bytes <= block.size) {
+            used = offset + bytes;
+            total += bytes;
+            return block.data + offset;
+        }
+    }
+
+    // Fresh blocks come from operator new, which is aligned for anything ordinary
+    addBlock(bytes);
+    used = bytes;
+    total += bytes;
+    return blocks.back().data;
+}
+
+void Arena::reset()
+{
+    // Several blocks mean the last round outgrew the first one.  Swap them for one block big enough for all of it
+    if (blocks.size() > 1) {
+        std::size_t size = bytesReserved();
+        release();
+        addBlock(size);
+    }
+    used = 0;
+    total = 0;
+}
+
+void Arena::release()
+{
+    for (Block& block : blocks)
+        ::operator delete(block.data);
+    blocks.clear();
+    used = 0;
+    total = 0;
+}
+
+std::size_t Arena::bytesReserved() const
+{
+    std::size_t size = 0;
+    for (const Block& block : blocks)
+        size += block.size;
+    return size;
+}
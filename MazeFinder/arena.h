@@ -0,0 +1,86 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/*
+    Monotonic arena.  allocate() bumps a pointer inside big blocks and individual frees do nothing.
+    reset() rewinds it for reuse (one block of the peak size is kept), release() and the destructor
+    hand everything back in one go.  Nothing is destructed, owners of non trivial objects must do that first.
+
+    ArenaAllocator plugs an arena into std containers.  Growing a vector leaves its old buffer behind
+    until the next reset(), so total waste is bounded by the usual geometric growth.
+*/
+class Arena
+{
+private:
+    struct Block
+    {
+        char * data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t blockSize; // Smallest block to ask the system for
+    std::size_t used; // Bytes used in blocks.back()
+    std::size_t total; // Bytes handed out since the last reset()
+
+    void addBlock(std::size_t minimum);
+
+public:
+    //Constructor and Destructor
+    explicit Arena(std::size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    void * allocate(std::size_t bytes, std::size_t alignment);
+
+    template <class T>
+    T * allocateArray(std::size_t count)
+    {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset(); // Everything allocated so far is dead, memory is kept for the next round
+    void release(); // Everything allocated so far is dead, memory goes back to the system
+
+    std::size_t bytesUsed() const { return total; }
+    std::size_t bytesReserved() const;
+
+    // Make it Non Copyable
+    Arena(const Arena &) = delete;
+    Arena &operator= (const Arena &) = delete;
+};
+
+template <class T>
+class ArenaAllocator
+{
+private:
+    Arena * arena;
+
+    template <class U> friend class ArenaAllocator;
+
+public:
+    typedef T value_type;
+
+    // Containers assigned from an arena bound empty container take its arena
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() : arena(nullptr) {}
+    explicit ArenaAllocator(Arena * arena) : arena(arena) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T * allocate(std::size_t count) { return arena->allocateArray<T>(count); }
+    void deallocate(T *, std::size_t) {} // Freed in bulk by the arena
+
+    template <class U> bool operator== (const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <class U> bool operator!= (const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // !ARENA_H
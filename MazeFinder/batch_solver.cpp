@@ -0,0 +1,157 @@
+#include "batch_solver.h"
+#include "component_labels.h"
+
+#include <algorithm>
+#include <chrono>
+
+const unsigned int BatchSolver::NO_KEY;
+const unsigned int BatchSolver::SHARED_MIN_QUERIES;
+const unsigned int BatchSolver::QUERIES_PER_TASK;
+
+BatchSolver::BatchSolver(ThreadPool & pool)
+    : pool(pool), workers(pool.size())
+{
+}
+
+BatchStats BatchSolver::solve(const Maze & maze, Algorithm algo, const std::vector<Query>& queries, std::vector<SolveResult>& results,
+    const ComponentLabels * components)
+{
+    auto begin = std::chrono::steady_clock::now();
+    BatchStats stats = {};
+    stats.queries = static_cast<unsigned int>(queries.size());
+    SolveResult notFound = { false, 0, 0 };
+    results.assign(queries.size(), notFound);
+    for (Worker& worker : workers)
+        worker.expanded = 0;
+
+    // Bad cells and other components are settled here, everything else gets a key or goes to searchOrder
+    keys.assign(queries.size(), NO_KEY);
+    searchOrder.clear();
+    live.clear();
+    for (unsigned int i = 0; i < queries.size(); ++i)
+    {
+        const Query& query = queries[i];
+        if (query.start >= maze.cellCount() || query.end >= maze.cellCount() || maze.isWall(query.start) || maze.isWall(query.end))
+            continue;
+        if (components && !components->connected(query.start, query.end)) {
+            ++stats.unreachable;
+            continue;
+        }
+        live.push_back(i);
+    }
+
+    if (algo == Algorithm::DFS) {
+        searchOrder = live;
+    }
+    else {
+        cellCounts.resize(maze.cellCount(), 0);
+        for (unsigned int i : live)
+        {
+            ++cellCounts[queries[i].start];
+            if (queries[i].end != queries[i].start)
+                ++cellCounts[queries[i].end];
+        }
+        for (unsigned int i : live)
+        {
+            unsigned int start = queries[i].start;
+            unsigned int end = queries[i].end;
+            unsigned int key = cellCounts[end] >= cellCounts[start] ? end : start;
+            if (cellCounts[key] >= SHARED_MIN_QUERIES)
+                keys[i] = key;
+            else
+                searchOrder.push_back(i);
+        }
+        for (unsigned int i : live)
+        {
+            cellCounts[queries[i].start] = 0;
+            cellCounts[queries[i].end] = 0;
+        }
+    }
+
+    // Shared queries, split into traversals of at most LANES keys.  With few keys there are still
+    // as many traversals as workers, a lane per traversal beats leaving threads idle
+    sharedOrder.clear();
+    for (unsigned int i : live)
+    {
+        if (keys[i] != NO_KEY)
+            sharedOrder.push_back(i);
+    }
+    std::sort(sharedOrder.begin(), sharedOrder.end(), [this](unsigned int a, unsigned int b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    });
+    unsigned int keyCount = 0;
+    for (size_t i = 0; i < sharedOrder.size(); ++i)
+    {
+        if (i == 0 || keys[sharedOrder[i]] != keys[sharedOrder[i - 1]])
+            ++keyCount;
+    }
+    unsigned int traversals = std::max((keyCount + MultiSourceBFS::LANES - 1) / MultiSourceBFS::LANES, std::min(keyCount, pool.size()));
+
+    size_t first = 0;
+    while (first < sharedOrder.size())
+    {
+        unsigned int keysHere = (keyCount + traversals - stats.traversals - 1) / (traversals - stats.traversals);
+        size_t last = first;
+        unsigned int taken = 0;
+        while (last < sharedOrder.size())
+        {
+            if (last == first || keys[sharedOrder[last]] != keys[sharedOrder[last - 1]]) {
+                if (taken == keysHere)
+                    break;
+                ++taken;
+            }
+            ++last;
+        }
+        keyCount -= taken;
+        ++stats.traversals;
+        pool.enqueue([this, &maze, &queries, &results, first, last](unsigned int index) {
+            Worker& worker = workers[index];
+            worker.batch.clear();
+            for (size_t k = first; k < last; ++k)
+            {
+                const Query& query = queries[sharedOrder[k]];
+                unsigned int key = keys[sharedOrder[k]];
+                Query flipped = { key, key == query.start ? query.end : query.start };
+                worker.batch.push_back(flipped);
+            }
+            worker.lanes.solveBatch(maze, worker.batch, worker.lengths);
+            for (size_t k = first; k < last; ++k)
+            {
+                unsigned int length = worker.lengths[k - first];
+                if (length != MultiSourceBFS::UNREACHED) {
+                    SolveResult result = { true, length, 0 };
+                    results[sharedOrder[k]] = result;
+                }
+            }
+        });
+        first = last;
+    }
+
+    for (size_t from = 0; from < searchOrder.size(); from += QUERIES_PER_TASK)
+    {
+        size_t to = std::min(searchOrder.size(), from + QUERIES_PER_TASK);
+        pool.enqueue([this, &maze, algo, &queries, &results, from, to](unsigned int index) {
+            Worker& worker = workers[index];
+            for (size_t k = from; k < to; ++k)
+            {
+                const Query& query = queries[searchOrder[k]];
+                SolveResult result = ::solve(maze, worker.context, algo, query.start, query.end);
+                worker.expanded += result.expanded;
+                results[searchOrder[k]] = result;
+            }
+        });
+    }
+    pool.wait();
+
+    stats.shared = static_cast<unsigned int>(sharedOrder.size());
+    stats.searched = static_cast<unsigned int>(searchOrder.size());
+    for (const Worker& worker : workers)
+        stats.expanded += worker.expanded;
+    for (const SolveResult& result : results)
+    {
+        if (result.found)
+            ++stats.found;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return stats;
+}
@@ -0,0 +1,79 @@
+#ifndef BATCH_SOLVER_H
+#define BATCH_SOLVER_H
+
+#include <vector>
+
+#include "maze.h"
+#include "solver.h"
+#include "search_context.h"
+#include "ms_bfs.h"
+#include "thread_pool.h"
+
+class ComponentLabels; // component_labels.h
+
+// What one solve() call did
+struct BatchStats
+{
+    unsigned int queries;
+    unsigned int found;
+    unsigned int unreachable; // Answered by the component labels, no search at all
+    unsigned int shared; // Answered by a MultiSourceBFS traversal with other queries on the same cell
+    unsigned int traversals; // MultiSourceBFS calls those took
+    unsigned int searched; // One search each
+    unsigned long long expanded; // Summed over the searched queries
+    double seconds;
+
+    double queriesPerSecond() const { return seconds > 0 ? queries / seconds : 0.0; }
+};
+
+/*
+    Thousands of queries on one maze, spread over a pool.  results[i] always belongs to queries[i].
+
+    Moves are undirected, so a query can be answered from either end.  Each BFS / A* query is keyed by whichever
+    of its cells more queries in the batch share.  Keys with SHARED_MIN_QUERIES or more go to MultiSourceBFS
+    flipped so the key is the start, one lane per key, up to 64 keys per traversal.  The rest are solved one by one
+    with the worker's own SearchContext, QUERIES_PER_TASK to a task so the pool's queue isn't the bottleneck.
+    DFS answers depend on the search order, so DFS queries are never shared.
+
+    Shared answers have the same found / pathLength as the single solve, expanded is 0 for them.
+    With components (built for this maze) queries between components are answered before anything is queued.
+*/
+class BatchSolver
+{
+private:
+    struct Worker
+    {
+        SearchContext context;
+        MultiSourceBFS lanes;
+        std::vector<Query> batch; // One traversal's queries, flipped
+        std::vector<unsigned int> lengths;
+        unsigned long long expanded;
+    };
+
+    ThreadPool& pool;
+    std::vector<Worker> workers;
+
+    // Scratch between calls
+    std::vector<unsigned int> live; // Queries that still need an answer
+    std::vector<unsigned int> keys; // Per query: the cell it is grouped on, or NO_KEY
+    std::vector<unsigned int> sharedOrder; // Shared queries by key
+    std::vector<unsigned int> searchOrder;
+    std::vector<unsigned int> cellCounts; // Queries touching each cell, only the cells of this batch are non zero
+
+public:
+    static const unsigned int NO_KEY = UINT_MAX;
+    static const unsigned int SHARED_MIN_QUERIES = 4; // Fewer on one cell and single A* searches are cheaper
+    static const unsigned int QUERIES_PER_TASK = 64;
+
+    //Constructor
+    explicit BatchSolver(ThreadPool& pool);
+
+    BatchStats solve(const Maze& maze, Algorithm algo, const std::vector<Query>& queries, std::vector<SolveResult>& results,
+        const ComponentLabels * components = nullptr);
+
+    // Make it Non Copyable
+    BatchSolver(const BatchSolver &) = delete;
+    BatchSolver &operator= (const BatchSolver &) = delete;
+};
+
+#endif // !BATCH_SOLVER_H
@@ -0,0 +1,396 @@
+#include "bench_compare.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <set>
+
+namespace {
+
+    // Recursive descent over the whole text, pos always points at the next unread char
+    class JsonParser
+    {
+    private:
+        const std::string& text;
+        size_t pos;
+        std::string error;
+
+        void skipSpace()
+        {
+            while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r'))
+                ++pos;
+        }
+
+        bool fail(const std::string& message)
+        {
+            if (error.empty())
+                error = message + " at offset " + std::to_string(pos);
+            return false;
+        }
+
+        bool expect(char c)
+        {
+            skipSpace();
+            if (pos >= text.size() || text[pos] != c)
+                return fail(std::string("expected '") + c + "'");
+            ++pos;
+            return true;
+        }
+
+        bool parseString(std::string& out)
+        {
+            if (!expect('"'))
+                return false;
+            out.clear();
+            while (pos < text.size() && text[pos] != '"')
+            {
+                if (text[pos] == '\\' && pos + 1 < text.size()) {
+                    ++pos;
+                    switch (text[pos]) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': // Benchmark names are ASCII, keep the escape as is
+                        out += "\\u";
+                        break;
+                    default: out += text[pos]; break;
+                    }
+                }
+                else
+                    out += text[pos];
+                ++pos;
+            }
+            if (pos >= text.size())
+                return fail("unterminated string");
+            ++pos;
+            return true;
+        }
+
+        bool parseLiteral(const char * literal)
+        {
+            size_t length = std::char_traits<char>::length(literal);
+            if (text.compare(pos, length, literal) != 0)
+                return fail("unexpected token");
+            pos += length;
+            return true;
+        }
+
+    public:
+        explicit JsonParser(const std::string& text) : text(text), pos(0) {}
+
+        const std::string& getError() const { return error; }
+
+        bool atEnd()
+        {
+            skipSpace();
+            return pos >= text.size();
+        }
+
+        bool parseValue(JsonValue& value)
+        {
+            skipSpace();
+            if (pos >= text.size())
+                return fail("unexpected end");
+
+            char c = text[pos];
+            if (c == '{') {
+                ++pos;
+                value.type = JsonValue::JSON_OBJECT;
+                skipSpace();
+                if (pos < text.size() && text[pos] == '}') {
+                    ++pos;
+                    return true;
+                }
+                while (true) {
+                    std::pair<std::string, JsonValue> member;
+                    skipSpace();
+                    if (!parseString(member.first) || !expect(':') || !parseValue(member.second))
+                        return false;
+                    value.members.push_back(std::move(member));
+                    skipSpace();
+                    if (pos < text.size() && text[pos] == ',') {
+                        ++pos;
+                        continue;
+                    }
+                    return expect('}');
+                }
+            }
+            else if (c == '[') {
+                ++pos;
+                value.type = JsonValue::JSON_ARRAY;
+                skipSpace();
+                if (pos < text.size() && text[pos] == ']') {
+                    ++pos;
+                    return true;
+                }
+                while (true) {
+                    JsonValue item;
+                    if (!parseValue(item))
+                        return false;
+                    value.items.push_back(std::move(item));
+                    skipSpace();
+                    if (pos < text.size() && text[pos] == ',') {
+                        ++pos;
+                        continue;
+                    }
+                    return expect(']');
+                }
+            }
+            else if (c == '"') {
+                value.type = JsonValue::JSON_STRING;
+                return parseString(value.text);
+            }
+            else if (c == 't' || c == 'f') {
+                value.type = JsonValue::JSON_BOOL;
+                value.boolean = (c == 't');
+                return parseLiteral(c == 't' ? "true" : "false");
+            }
+            else if (c == 'n') {
+                value.type = JsonValue::JSON_NULL;
+                return parseLiteral("null");
+            }
+
+            const char * begin = text.c_str() + pos;
+            char * endPtr = nullptr;
+            value.type = JsonValue::JSON_NUMBER;
+            value.number = std::strtod(begin, &endPtr);
+            if (endPtr == begin)
+                return fail("unexpected character");
+            pos += endPtr - begin;
+            return true;
+        }
+    };
+
+    double numberOr(const JsonValue * value, double fallback)
+    {
+        return (value && value->type == JsonValue::JSON_NUMBER) ? value->number : fallback;
+    }
+
+    const char * verdictName(Comparison::e_verdict verdict)
+    {
+        switch (verdict) {
+        case Comparison::SAME: return "ok";
+        case Comparison::REGRESSED: return "REGRESSED";
+        case Comparison::IMPROVED: return "improved";
+        case Comparison::MISSING: return "missing";
+        case Comparison::NEW: return "new";
+        }
+        return "?";
+    }
+
+}  // namespace
+
+const JsonValue * JsonValue::find(const std::string & key) const
+{
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return &member.second;
+    }
+    return nullptr;
+}
+
+bool parseJson(const std::string & text, JsonValue & value, std::string & error)
+{
+    JsonParser parser(text);
+    if (!parser.parseValue(value) || !parser.atEnd()) {
+        error = parser.getError().empty() ? "trailing characters" : parser.getError();
+        return false;
+    }
+    return true;
+}
+
+bool loadBaseline(const std::string & fname, std::vector<BaselineEntry>& entries, BenchmarkOptions & options, std::string & error)
+{
+    std::ifstream file(fname);
+    if (!file.is_open()) {
+        error = "Could not open baseline " + fname;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    JsonValue root;
+    if (!parseJson(buffer.str(), root, error)) {
+        error = fname + ": " + error;
+        return false;
+    }
+
+    const JsonValue * benchmarks = root.find("benchmarks");
+    if (root.type != JsonValue::JSON_OBJECT || !benchmarks || benchmarks->type != JsonValue::JSON_ARRAY) {
+        error = fname + ": not a mazefinder bench JSON file";
+        return false;
+    }
+
+    options.seed = static_cast<unsigned int>(numberOr(root.find("seed"), options.seed));
+    options.minTime = numberOr(root.find("min_time"), options.minTime);
+    options.repeat = static_cast<unsigned int>(numberOr(root.find("repeat"), options.repeat));
+
+    std::set<unsigned int> sizes;
+    entries.clear();
+    for (const JsonValue& item : benchmarks->items)
+    {
+        const JsonValue * name = item.find("name");
+        if (!name || name->type != JsonValue::JSON_STRING)
+            continue;
+
+        BaselineEntry entry;
+        entry.name = name->text;
+        entry.size = static_cast<unsigned int>(numberOr(item.find("size"), 0));
+        entry.nsPerOp = numberOr(item.find("ns_per_op"), 0.0);
+        const JsonValue * samples = item.find("samples");
+        if (samples && samples->type == JsonValue::JSON_ARRAY) {
+            for (const JsonValue& sample : samples->items)
+                entry.samples.push_back(numberOr(&sample, 0.0));
+        }
+        if (entry.size >= 4)
+            sizes.insert(entry.size);
+        entries.push_back(entry);
+    }
+
+    if (!sizes.empty())
+        options.sizes.assign(sizes.begin(), sizes.end());
+    return true;
+}
+
+double mannWhitneyGreater(const std::vector<double>& a, const std::vector<double>& b)
+{
+    size_t n1 = a.size();
+    size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0)
+        return 1.0;
+
+    // Rank both samples together, ties share their average rank
+    std::vector<std::pair<double, int>> all; // value, 0 = a, 1 = b
+    for (double value : a)
+        all.push_back({ value, 0 });
+    for (double value : b)
+        all.push_back({ value, 1 });
+    std::sort(all.begin(), all.end());
+
+    double rankSumA = 0.0;
+    double tieTerm = 0.0;
+    size_t n = all.size();
+    for (size_t i = 0; i < n; )
+    {
+        size_t j = i;
+        while (j < n && all[j].first == all[i].first)
+            ++j;
+        double averageRank = (i + 1 + j) / 2.0; // Ranks i+1..j
+        for (size_t k = i; k < j; ++k)
+        {
+            if (all[k].second == 0)
+                rankSumA += averageRank;
+        }
+        double t = static_cast<double>(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    double u = rankSumA - n1 * (n1 + 1) / 2.0;
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1.0)));
+    if (variance <= 0.0)
+        return 1.0;
+
+    // Continuity corrected, upper tail
+    double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<Comparison> compareResults(const std::vector<BaselineEntry>& baseline, const std::vector<BenchmarkResult>& current, const CompareOptions & options)
+{
+    std::vector<Comparison> comparisons;
+    std::set<std::string> seen;
+
+    for (const BaselineEntry& entry : baseline)
+    {
+        Comparison comparison;
+        comparison.name = entry.name;
+        comparison.baselineNs = entry.samples.empty() ? entry.nsPerOp : median(entry.samples);
+        comparison.currentNs = 0.0;
+        comparison.change = 0.0;
+        comparison.pValue = -1.0;
+        comparison.verdict = Comparison::MISSING;
+        seen.insert(entry.name);
+
+        auto it = std::find_if(current.begin(), current.end(), [&](const BenchmarkResult& result) { return result.name == entry.name; });
+        if (it == current.end()) {
+            comparisons.push_back(comparison);
+            continue;
+        }
+
+        comparison.currentNs = it->nsPerOp;
+        comparison.change = comparison.baselineNs > 0.0 ? (comparison.currentNs - comparison.baselineNs) / comparison.baselineNs : 0.0;
+
+        // Without samples on both sides there is no test, so the threshold decides alone
+        bool testable = entry.samples.size() >= 2 && it->samples.size() >= 2;
+        bool slower = comparison.change > options.threshold;
+        bool faster = comparison.change < -options.threshold;
+        if (testable)
+            comparison.pValue = comparison.change >= 0.0 ? mannWhitneyGreater(it->samples, entry.samples) : mannWhitneyGreater(entry.samples, it->samples);
+        bool significant = !testable || comparison.pValue < options.alpha;
+
+        if (slower && significant)
+            comparison.verdict = Comparison::REGRESSED;
+        else if (faster && significant)
+            comparison.verdict = Comparison::IMPROVED;
+        else
+            comparison.verdict = Comparison::SAME;
+        comparisons.push_back(comparison);
+    }
+
+    for (const BenchmarkResult& result : current)
+    {
+        if (seen.count(result.name))
+            continue;
+        Comparison comparison;
+        comparison.name = result.name;
+        comparison.baselineNs = 0.0;
+        comparison.currentNs = result.nsPerOp;
+        comparison.change = 0.0;
+        comparison.pValue = -1.0;
+        comparison.verdict = Comparison::NEW;
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+void printComparison(std::ostream & out, const std::vector<Comparison>& comparisons)
+{
+    out << std::left << std::setw(24) << "benchmark" << std::right <<
+        std::setw(16) << "baseline ns/op" <<
+        std::setw(16) << "current ns/op" <<
+        std::setw(10) << "change" <<
+        std::setw(10) << "p" <<
+        "  verdict\n";
+
+    for (const Comparison& comparison : comparisons)
+    {
+        out << std::left << std::setw(24) << comparison.name << std::right << std::fixed <<
+            std::setw(16) << std::setprecision(1) << comparison.baselineNs <<
+            std::setw(16) << comparison.currentNs <<
+            std::setw(9) << comparison.change * 100.0 << '%';
+        if (comparison.pValue >= 0.0)
+            out << std::setw(10) << std::setprecision(4) << comparison.pValue;
+        else
+            out << std::setw(10) << "-";
+        out << "  " << verdictName(comparison.verdict) << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+bool hasRegression(const std::vector<Comparison>& comparisons)
+{
+    for (const Comparison& comparison : comparisons)
+    {
+        if (comparison.verdict == Comparison::REGRESSED)
+            return true;
+    }
+    return false;
+}
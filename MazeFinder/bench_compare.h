@@ -0,0 +1,76 @@
+#ifndef BENCH_COMPARE_H
+#define BENCH_COMPARE_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+
+#include "benchmark.h"
+
+/*
+    Regression check against a stored "mazefinder bench --json" baseline.
+
+    mazefinder bench --baseline base.json [--threshold 0.10] [--alpha 0.05]
+
+    Every benchmark is re-run "repeat" times.  One is flagged as REGRESSED only when its median
+    ns/op got slower by more than the threshold AND a one-sided Mann-Whitney U test on the
+    samples says the slowdown is significant at alpha.  Either alone is too noisy to gate on.
+*/
+
+// Minimal JSON reader.  Enough for benchmark baselines, not a general purpose parser
+struct JsonValue
+{
+    enum e_jsonType { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+    e_jsonType type = JSON_NULL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> items; // Array
+    std::vector<std::pair<std::string, JsonValue>> members; // Object, in file order
+
+    const JsonValue * find(const std::string& key) const;
+};
+
+bool parseJson(const std::string& text, JsonValue& value, std::string& error);
+
+struct BaselineEntry
+{
+    std::string name;
+    unsigned int size;
+    double nsPerOp;
+    std::vector<double> samples;
+};
+
+// Also copies seed / min_time / repeat / sizes from the baseline into options so the rerun matches
+bool loadBaseline(const std::string& fname, std::vector<BaselineEntry>& entries, BenchmarkOptions& options, std::string& error);
+
+struct CompareOptions
+{
+    double threshold; // Relative slowdown, 0.10 = 10%
+    double alpha; // Significance level
+
+    CompareOptions() : threshold(0.10), alpha(0.05) {}
+};
+
+struct Comparison
+{
+    enum e_verdict { SAME, REGRESSED, IMPROVED, MISSING, NEW };
+
+    std::string name;
+    double baselineNs;
+    double currentNs;
+    double change; // (current - baseline) / baseline
+    double pValue; // One-sided, in the direction of the change.  Negative when there were too few samples
+    e_verdict verdict;
+};
+
+// P-value for "a tends to be larger than b", normal approximation with tie correction
+double mannWhitneyGreater(const std::vector<double>& a, const std::vector<double>& b);
+
+std::vector<Comparison> compareResults(const std::vector<BaselineEntry>& baseline, const std::vector<BenchmarkResult>& current, const CompareOptions& options);
+void printComparison(std::ostream& out, const std::vector<Comparison>& comparisons);
+bool hasRegression(const std::vector<Comparison>& comparisons);
+
+#endif // !BENCH_COMPARE_H
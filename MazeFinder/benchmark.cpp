@@ -0,0 +1,639 @@
+#include "benchmark.h"
+#include "alloc_counter.h"
+#include "maze.h"
+#include "solver.h"
+#include "search_context.h"
+#include "bit_grid.h"
+#include "ms_bfs.h"
+#include "parallel_bfs.h"
+#include "parallel_astar.h"
+#include "parallel_dfs.h"
+#include "component_labels.h"
+#include "dstar_lite.h"
+#include "batch_solver.h"
+#include "flow_field.h"
+#include "crowd.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+    // Keeps the optimizer from throwing away results
+    volatile unsigned long long benchmarkSink = 0;
+
+    const unsigned int QUERY_COUNT = 8;
+    const unsigned int MSBFS_GOALS = 4; // Distinct goals in the msbfs batch, at most QUERY_COUNT
+    const unsigned int BATCH_QUERIES = 1024;
+    const unsigned int HEAP_ENTRIES_PER_ROW = 16;
+    const unsigned int OPEN_WALL_RATIO = 20; // One wall per this many cells in the open field map
+    const unsigned int EDITS_PER_ITERATION = 64; // Cells toggled and back per components_edit iteration
+    const unsigned int CROWD_AGENTS = 10000;
+    const float CROWD_FRAME = 1.0f / 60.0f; // Seconds per crowd step
+
+}  // namespace
+
+BenchmarkOptions::BenchmarkOptions()
+{
+    sizes = { 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    seed = 7;
+    minTime = 0.2;
+    repeat = 5;
+    fixedCalls = 0;
+}
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions & options)
+{
+    this->options = options;
+}
+
+bool BenchmarkSuite::selected(const std::string & name) const
+{
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+void BenchmarkSuite::measure(const std::string & name, const std::string & group, unsigned int size, unsigned long long opsPerCall, const std::function<unsigned long long()>& op)
+{
+    // Warm up once so lazily grown buffers don't show up as steady state allocations
+    benchmarkSink = benchmarkSink + op();
+
+    BenchmarkResult result;
+    unsigned long long totalCalls = 0;
+    unsigned long long nodes = 0;
+    double totalElapsed = 0.0;
+    result.samples.reserve(std::max(options.repeat, 1U)); // Not counted against the benchmark
+    AllocCounter::Snapshot allocBegin = AllocCounter::now();
+    for (unsigned int sample = 0; sample < std::max(options.repeat, 1U); ++sample)
+    {
+        unsigned long long calls = 0;
+        auto begin = std::chrono::steady_clock::now();
+        double elapsed = 0.0;
+        do {
+            nodes += op();
+            ++calls;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        } while (options.fixedCalls > 0 ? calls < options.fixedCalls : elapsed < options.minTime);
+
+        result.samples.push_back(elapsed * 1e9 / (calls * opsPerCall));
+        totalCalls += calls;
+        totalElapsed += elapsed;
+    }
+    AllocCounter::Snapshot allocEnd = AllocCounter::now();
+
+    result.name = name;
+    result.group = group;
+    result.size = size;
+    result.iterations = totalCalls * opsPerCall;
+    result.nsPerOp = median(result.samples);
+    result.nodesPerSecond = nodes / totalElapsed;
+    result.allocsPerOp = static_cast<double>(allocEnd.count - allocBegin.count) / result.iterations;
+    result.bytesPerOp = static_cast<double>(allocEnd.bytes - allocBegin.bytes) / result.iterations;
+    results.push_back(result);
+}
+
+void BenchmarkSuite::runGenerator(unsigned int size)
+{
+    std::string name = "generate/" + std::to_string(size);
+    if (!selected(name))
+        return;
+
+    Maze maze(size);
+    measure(name, "generator", size, 1, [&]() {
+        maze.generate(options.seed);
+        return static_cast<unsigned long long>(maze.cellCount());
+    });
+}
+
+void BenchmarkSuite::runSolvers(unsigned int size)
+{
+    const Algorithm algorithms[] = { Algorithm::BFS, Algorithm::DFS, Algorithm::AStar };
+    bool any = false;
+    for (Algorithm algo : algorithms)
+        any = any || selected(std::string(algorithmName(algo)) + "/" + std::to_string(size));
+    any = any || selected("reach/" + std::to_string(size)) || selected("bfs_layers/" + std::to_string(size)) ||
+        selected("msbfs/" + std::to_string(size)) || selected("hda/" + std::to_string(size)) ||
+        selected("batch/" + std::to_string(size));
+    if (!any)
+        return;
+
+    Maze maze(size);
+    maze.generate(options.seed);
+
+    // Same endpoints for every algorithm so their numbers compare
+    std::mt19937 random(options.seed + size);
+    std::vector<unsigned int> starts;
+    std::vector<unsigned int> ends;
+    for (unsigned int i = 0; i < QUERY_COUNT; ++i) {
+        starts.push_back(maze.randomPathCell(random));
+        ends.push_back(maze.randomPathCell(random));
+    }
+
+    for (Algorithm algo : algorithms)
+    {
+        std::string name = std::string(algorithmName(algo)) + "/" + std::to_string(size);
+        if (!selected(name))
+            continue;
+
+        unsigned int next = 0;
+        SearchContext context; // Reused like a worker thread would
+        for (unsigned int i = 0; i < QUERY_COUNT; ++i)
+            solve(maze, context, algo, starts[i], ends[i]); // Every query once, so the largest frontier is already paid for
+        measure(name, "solver", size, 1, [&]() {
+            SolveResult result = solve(maze, context, algo, starts[next], ends[next]);
+            next = (next + 1) % QUERY_COUNT;
+            return static_cast<unsigned long long>(result.expanded);
+        });
+    }
+
+    // Word parallel versions on the bit packed copy, same queries.  Nodes are the 64 cells of every word touched
+    BitGrid bits(maze);
+    BitScratch scratch;
+    std::string name = "reach/" + std::to_string(size);
+    if (selected(name)) {
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < QUERY_COUNT; ++i)
+            bits.isReachable(scratch, starts[i], ends[i]);
+        measure(name, "solver", size, 1, [&]() {
+            benchmarkSink = benchmarkSink + bits.isReachable(scratch, starts[next], ends[next]);
+            next = (next + 1) % QUERY_COUNT;
+            return static_cast<unsigned long long>(scratch.touched.size()) * 64;
+        });
+    }
+
+    name = "bfs_layers/" + std::to_string(size);
+    if (selected(name)) {
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < QUERY_COUNT; ++i)
+            bits.layerDistance(scratch, starts[i], ends[i]);
+        measure(name, "solver", size, 1, [&]() {
+            benchmarkSink = benchmarkSink + bits.layerDistance(scratch, starts[next], ends[next]);
+            next = (next + 1) % QUERY_COUNT;
+            return static_cast<unsigned long long>(scratch.touched.size()) * 64;
+        });
+    }
+
+    // Batch shape: random starts heading for a few shared goals.  ns/op is per query, like bfs/N, nodes are queries
+    name = "msbfs/" + std::to_string(size);
+    if (selected(name)) {
+        std::vector<Query> batch;
+        for (unsigned int i = 0; i < MultiSourceBFS::LANES; ++i)
+            batch.push_back({ maze.randomPathCell(random), ends[i % MSBFS_GOALS] });
+        MultiSourceBFS msbfs;
+        std::vector<unsigned int> lengths;
+        msbfs.solveBatch(maze, batch, lengths);
+        measure(name, "solver", size, batch.size(), [&]() {
+            msbfs.solveBatch(maze, batch, lengths);
+            return static_cast<unsigned long long>(lengths.size());
+        });
+    }
+
+    // Same queries as astar/N spread over every hardware thread.  Handing tasks to the pool allocates, so its own group
+    name = "hda/" + std::to_string(size);
+    if (selected(name)) {
+        ThreadPool pool;
+        ParallelAStar hda(pool);
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < QUERY_COUNT; ++i)
+            hda.solve(maze, starts[i], ends[i]);
+        measure(name, "parallel", size, 1, [&]() {
+            SolveResult result = hda.solve(maze, starts[next], ends[next]);
+            next = (next + 1) % QUERY_COUNT;
+            return static_cast<unsigned long long>(result.expanded);
+        });
+    }
+
+    // msbfs/N's batch shape at production size, half to shared goals and half random A*, on every hardware thread
+    name = "batch/" + std::to_string(size);
+    if (selected(name)) {
+        std::vector<Query> batch;
+        for (unsigned int i = 0; i < BATCH_QUERIES; ++i)
+        {
+            unsigned int end = i % 2 ? ends[i % MSBFS_GOALS] : maze.randomPathCell(random);
+            batch.push_back({ maze.randomPathCell(random), end });
+        }
+        ThreadPool pool;
+        BatchSolver solver(pool);
+        std::vector<SolveResult> results;
+        solver.solve(maze, Algorithm::AStar, batch, results);
+        measure(name, "parallel", size, batch.size(), [&]() {
+            BatchStats stats = solver.solve(maze, Algorithm::AStar, batch, results);
+            return static_cast<unsigned long long>(stats.queries);
+        });
+    }
+}
+
+void BenchmarkSuite::runFields(unsigned int size)
+{
+    std::string serialName = "field_serial/" + std::to_string(size);
+    std::string parallelName = "field_parallel/" + std::to_string(size);
+    std::string topDownName = "field_open_topdown/" + std::to_string(size);
+    std::string optimizingName = "field_open_diropt/" + std::to_string(size);
+    std::string regionsSerialName = "regions_serial/" + std::to_string(size);
+    std::string regionsParallelName = "regions_parallel/" + std::to_string(size);
+    std::string componentsSerialName = "components_serial/" + std::to_string(size);
+    std::string componentsParallelName = "components_parallel/" + std::to_string(size);
+    std::string editOpenName = "components_edit_open/" + std::to_string(size);
+    std::string editMazeName = "components_edit_maze/" + std::to_string(size);
+    std::string flowBitsName = "flowfield_bits/" + std::to_string(size);
+    std::string flowParallelName = "flowfield_parallel/" + std::to_string(size);
+    std::string crowdSerialName = "crowd_serial/" + std::to_string(size);
+    std::string crowdParallelName = "crowd_parallel/" + std::to_string(size);
+    if (!selected(serialName) && !selected(parallelName) && !selected(topDownName) && !selected(optimizingName) &&
+        !selected(regionsSerialName) && !selected(regionsParallelName) &&
+        !selected(componentsSerialName) && !selected(componentsParallelName) &&
+        !selected(editOpenName) && !selected(editMazeName) && !selected(flowBitsName) && !selected(flowParallelName) &&
+        !selected(crowdSerialName) && !selected(crowdParallelName))
+        return;
+
+    Maze maze(size);
+    maze.generate(options.seed);
+    std::mt19937 random(options.seed + size);
+    unsigned int start = maze.randomPathCell(random);
+    std::vector<unsigned int> distance;
+
+    // Mostly open map, a border and a sprinkle of single wall cells.  Frontiers there get wide fast
+    Maze openMaze(size);
+    openMaze.initOutside();
+    for (unsigned int i = 0; i < size * size / OPEN_WALL_RATIO; ++i)
+        openMaze.setWall(random() % size, random() % size, true);
+    unsigned int openStart = openMaze.randomPathCell(random);
+
+    // Same code both times, the serial one just has a single worker so every level stays on this thread
+    ThreadPool serialPool(1);
+    ThreadPool parallelPool;
+    ParallelBFS serial(serialPool);
+    ParallelBFS parallel(parallelPool);
+    struct FieldRun
+    {
+        std::string name;
+        ParallelBFS * bfs;
+        const Maze * maze;
+        unsigned int start;
+        BfsDirection direction;
+    };
+    FieldRun runs[] = {
+        { serialName, &serial, &maze, start, BfsDirection::Optimizing },
+        { parallelName, &parallel, &maze, start, BfsDirection::Optimizing },
+        { topDownName, &parallel, &openMaze, openStart, BfsDirection::TopDown },
+        { optimizingName, &parallel, &openMaze, openStart, BfsDirection::Optimizing }
+    };
+    for (const FieldRun& run : runs)
+    {
+        if (!selected(run.name))
+            continue;
+        measure(run.name, "field", size, 1, [&]() {
+            run.bfs->distances(*run.maze, run.start, distance, run.direction);
+            return static_cast<unsigned long long>(run.maze->cellCount());
+        });
+    }
+
+    // Region labels of the open map, lots of small regions plus one big one
+    ParallelDFS serialDfs(serialPool);
+    ParallelDFS parallelDfs(parallelPool);
+    std::pair<std::string, ParallelDFS*> regionRuns[] = { { regionsSerialName, &serialDfs }, { regionsParallelName, &parallelDfs } };
+    for (auto& run : regionRuns)
+    {
+        if (!selected(run.first))
+            continue;
+        measure(run.first, "field", size, 1, [&]() {
+            benchmarkSink = benchmarkSink + run.second->labelRegions(openMaze, distance);
+            return static_cast<unsigned long long>(openMaze.cellCount());
+        });
+    }
+
+    // Same labels from union-find
+    ComponentLabels components;
+    std::pair<std::string, ThreadPool*> componentRuns[] = { { componentsSerialName, nullptr }, { componentsParallelName, &parallelPool } };
+    for (auto& run : componentRuns)
+    {
+        if (!selected(run.first))
+            continue;
+        measure(run.first, "field", size, 1, [&]() {
+            if (run.second)
+                components.build(openMaze, *run.second);
+            else
+                components.build(openMaze);
+            benchmarkSink = benchmarkSink + components.count();
+            return static_cast<unsigned long long>(openMaze.cellCount());
+        });
+    }
+
+    // Flow field to start on the generated maze, word parallel BFS on one thread / ParallelBFS on every hardware thread
+    FlowField flow;
+    if (selected(flowBitsName)) {
+        BitGrid bits(maze);
+        measure(flowBitsName, "field", size, 1, [&]() {
+            flow.build(bits, start);
+            return static_cast<unsigned long long>(maze.cellCount());
+        });
+    }
+    if (selected(flowParallelName)) {
+        measure(flowParallelName, "field", size, 1, [&]() {
+            flow.build(maze, start, parallel);
+            return static_cast<unsigned long long>(maze.cellCount());
+        });
+    }
+
+    // A crowd walking the open map to openStart, one frame per call, on this thread / every hardware thread
+    std::pair<std::string, ThreadPool*> crowdRuns[] = { { crowdSerialName, nullptr }, { crowdParallelName, &parallelPool } };
+    for (auto& run : crowdRuns)
+    {
+        if (!selected(run.first))
+            continue;
+        FlowField openFlow;
+        openFlow.build(openMaze, openStart, parallel);
+        Crowd crowd(options.seed);
+        crowd.spawn(openFlow, CROWD_AGENTS);
+        measure(run.first, "field", size, CROWD_AGENTS, [&]() {
+            crowd.step(openFlow, CROWD_FRAME, run.second);
+            return static_cast<unsigned long long>(crowd.size());
+        });
+        benchmarkSink = benchmarkSink + crowd.getArrivals();
+    }
+
+    // Following single cell edits.  Each one is toggled and toggled back, so the maps don't drift.
+    // Closing a maze corridor splits it, the open map mostly just has searches that meet right away
+    std::pair<std::string, Maze> editRuns[] = { { editOpenName, openMaze }, { editMazeName, maze } };
+    for (auto& run : editRuns)
+    {
+        if (!selected(run.first))
+            continue;
+        Maze& edited = run.second;
+        components.build(edited);
+        std::mt19937 editRandom(options.seed);
+        measure(run.first, "field", size, 1, [&]() {
+            for (unsigned int i = 0; i < EDITS_PER_ITERATION; ++i)
+            {
+                unsigned int row = 1 + editRandom() % (size - 2);
+                unsigned int col = 1 + editRandom() % (size - 2);
+                unsigned int cell = edited.index(row, col);
+                bool wasPath = edited.isPath(cell);
+                for (int toggle = 0; toggle < 2; ++toggle)
+                {
+                    bool wall = (toggle == 0) == wasPath;
+                    edited.setWall(row, col, wall);
+                    if (wall)
+                        components.closeCell(edited, cell);
+                    else
+                        components.openCell(edited, cell);
+                }
+            }
+            benchmarkSink = benchmarkSink + components.count();
+            return static_cast<unsigned long long>(2 * EDITS_PER_ITERATION);
+        });
+    }
+}
+
+void BenchmarkSuite::runReplan(unsigned int size)
+{
+    std::string dstarName = "replan_dstar/" + std::to_string(size);
+    std::string astarName = "replan_astar/" + std::to_string(size);
+    if (!selected(dstarName) && !selected(astarName))
+        return;
+
+    // Same open map as the fields, corner to corner
+    std::mt19937 random(options.seed + size);
+    Maze openMaze(size);
+    openMaze.initOutside();
+    for (unsigned int i = 0; i < size * size / OPEN_WALL_RATIO; ++i)
+        openMaze.setWall(random() % size, random() % size, true);
+    openMaze.setWall(1, 1, false);
+    openMaze.setWall(size - 2, size - 2, false);
+    unsigned int start = openMaze.index(1, 1);
+    unsigned int end = openMaze.index(size - 2, size - 2);
+
+    // An obstacle drops onto the path and lifts again, each run edits its own current path
+    DStarLite planner;
+    SearchContext context;
+    std::vector<unsigned int> path;
+    std::pair<std::string, bool> runs[] = { { dstarName, true }, { astarName, false } };
+    for (auto& run : runs)
+    {
+        if (!selected(run.first))
+            continue;
+        bool dstar = run.second;
+        Maze maze = openMaze;
+        auto replan = [&]() {
+            SolveResult result = dstar ? planner.solve(&path) : solveAStar(maze, context, start, end, &path);
+            return static_cast<unsigned long long>(result.expanded);
+        };
+        if (dstar)
+            planner.begin(maze, start, end);
+        replan();
+        std::mt19937 editRandom(options.seed);
+        measure(run.first, "replan", size, 2, [&]() {
+            if (path.size() < 3)
+                return replan();
+            unsigned int cell = path[1 + editRandom() % (path.size() - 2)];
+            unsigned long long expanded = 0;
+            for (bool wall : { true, false })
+            {
+                maze.setWall(maze.rowOf(cell), maze.colOf(cell), wall);
+                if (dstar) // The A* run shouldn't pay for D* bookkeeping it never reads
+                    planner.setWall(cell, wall);
+                expanded += replan();
+            }
+            return expanded;
+        });
+    }
+}
+
+void BenchmarkSuite::runHeap(unsigned int size)
+{
+    unsigned int entries = size * HEAP_ENTRIES_PER_ROW;
+    std::mt19937 random(options.seed + size);
+    std::vector<HeapNode> nodes(entries);
+    for (unsigned int i = 0; i < entries; ++i) {
+        unsigned int h = random() % (2 * size);
+        unsigned int g = random() % (2 * size);
+        nodes[i] = { g + h, h, i };
+    }
+
+    MinHeap full;
+    full.reserve(entries);
+    for (const HeapNode& node : nodes)
+        full.heapInsert(node);
+
+    std::string name = "heap_insert/" + std::to_string(size);
+    if (selected(name)) {
+        MinHeap heap;
+        heap.reserve(entries);
+        measure(name, "heap", size, entries, [&]() {
+            heap.clear();
+            for (const HeapNode& node : nodes)
+                heap.heapInsert(node);
+            return static_cast<unsigned long long>(entries);
+        });
+    }
+
+    // Includes copying the prebuilt heap back in, which is a memcpy next to the sift downs
+    name = "heap_extract_min/" + std::to_string(size);
+    if (selected(name)) {
+        MinHeap heap;
+        heap.reserve(entries);
+        measure(name, "heap", size, entries, [&]() {
+            heap = full;
+            HeapNode node;
+            unsigned long long sum = 0;
+            while (heap.heapExtractMin(node))
+                sum += node.cell;
+            benchmarkSink = benchmarkSink + sum;
+            return static_cast<unsigned long long>(entries);
+        });
+    }
+
+    // Replace the top with a worse node and sift it down, the core of every extract
+    name = "heap_minheapify/" + std::to_string(size);
+    if (selected(name)) {
+        MinHeap heap = full;
+        unsigned int next = 0;
+        measure(name, "heap", size, entries, [&]() {
+            for (unsigned int i = 0; i < entries; ++i) {
+                HeapNode node = nodes[next];
+                node.f_cost += 4 * size;
+                heap.heapReplaceMin(node);
+                next = (next + 1) % entries;
+            }
+            return static_cast<unsigned long long>(entries);
+        });
+    }
+}
+
+void BenchmarkSuite::run()
+{
+    results.clear();
+    for (unsigned int size : options.sizes)
+    {
+        runGenerator(size);
+        runSolvers(size);
+        runFields(size);
+        runReplan(size);
+        runHeap(size);
+    }
+}
+
+void BenchmarkSuite::runSteadyState()
+{
+    results.clear();
+    for (unsigned int size : options.sizes)
+    {
+        runSolvers(size);
+        runHeap(size);
+    }
+}
+
+void BenchmarkSuite::printTable(std::ostream & out) const
+{
+    out << std::left << std::setw(24) << "benchmark" << std::right <<
+        std::setw(14) << "iterations" <<
+        std::setw(16) << "ns/op" <<
+        std::setw(16) << "nodes/s" <<
+        std::setw(14) << "allocs/op" <<
+        std::setw(14) << "bytes/op" << '\n';
+
+    for (const BenchmarkResult& result : results)
+    {
+        out << std::left << std::setw(24) << result.name << std::right <<
+            std::setw(14) << result.iterations <<
+            std::setw(16) << std::fixed << std::setprecision(1) << result.nsPerOp <<
+            std::setw(16) << std::scientific << std::setprecision(3) << result.nodesPerSecond <<
+            std::setw(14) << std::fixed << std::setprecision(2) << result.allocsPerOp <<
+            std::setw(14) << std::setprecision(1) << result.bytesPerOp << '\n';
+    }
+    out << std::defaultfloat;
+}
+
+void BenchmarkSuite::writeJson(std::ostream & out) const
+{
+    out << "{\n" <<
+        "  \"version\": 1,\n" <<
+        "  \"seed\": " << options.seed << ",\n" <<
+        "  \"min_time\": " << options.minTime << ",\n" <<
+        "  \"repeat\": " << options.repeat << ",\n" <<
+        "  \"benchmarks\": [";
+
+    out << std::setprecision(17);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        out << (i == 0 ? "\n" : ",\n") <<
+            "    {\"name\": \"" << result.name << "\", " <<
+            "\"group\": \"" << result.group << "\", " <<
+            "\"size\": " << result.size << ", " <<
+            "\"iterations\": " << result.iterations << ", " <<
+            "\"ns_per_op\": " << result.nsPerOp << ", " <<
+            "\"nodes_per_s\": " << result.nodesPerSecond << ", " <<
+            "\"allocs_per_op\": " << result.allocsPerOp << ", " <<
+            "\"bytes_per_op\": " << result.bytesPerOp << ", " <<
+            "\"samples\": [";
+        for (size_t j = 0; j < result.samples.size(); ++j)
+            out << (j == 0 ? "" : ", ") << result.samples[j];
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+bool parseSizeList(const std::string & text, std::vector<unsigned int>& sizes)
+{
+    sizes.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        char * endPtr = nullptr;
+        unsigned long value = std::strtoul(item.c_str(), &endPtr, 10);
+        if (item.empty() || *endPtr != '\0' || value < 4)
+            return false;
+        sizes.push_back(static_cast<unsigned int>(value));
+    }
+    return !sizes.empty();
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    if (values.size() % 2 == 1)
+        return values[mid];
+    return (values[mid - 1] + values[mid]) / 2.0;
+}
+
+bool checkSteadyStateAllocs(const std::vector<BenchmarkResult>& results, std::ostream& out)
+{
+    bool clean = true;
+    for (const BenchmarkResult& result : results)
+    {
+        if (result.group != "solver" && result.group != "heap")
+            continue;
+        if (result.allocsPerOp > 0.0) {
+            out << "ALLOC: " << result.name << " makes " << result.allocsPerOp << " allocations (" <<
+                result.bytesPerOp << " bytes) per op after warm up\n";
+            clean = false;
+        }
+    }
+    return clean;
+}
+
+bool checkAllocs(unsigned int size, unsigned int seed, unsigned long long calls, std::ostream & out)
+{
+    BenchmarkOptions options;
+    options.sizes = { size };
+    options.seed = seed;
+    options.repeat = 1;
+    options.fixedCalls = std::max(calls, 1ULL);
+
+    BenchmarkSuite suite(options);
+    suite.runSteadyState();
+    bool clean = checkSteadyStateAllocs(suite.getResults(), out);
+    out << suite.getResults().size() << " benchmarks, " << options.fixedCalls << " calls each: " <<
+        (clean ? "no allocations after warm up" : "ALLOCATIONS after warm up") << '\n';
+    return clean;
+}
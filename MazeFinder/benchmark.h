@@ -0,0 +1,101 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+/*
+    Headless microbenchmarks for the generator, the solvers and the A* heap.
+    Run with "mazefinder bench".  Every benchmark uses a fixed seed so runs are comparable.
+    "mazefinder check-allocs" runs only the solver and heap ones, a fixed number of times, to count allocations.
+
+    Names are "<what>/<gridSize>":
+    - generate/N        Maze::generate() on an N x N grid
+    - bfs/N, dfs/N, astar/N   One solve between fixed random path cells
+    - reach/N, bfs_layers/N   Same queries on a BitGrid: reachability only, and BFS distance only
+    - msbfs/N           64 BFS lengths in one MultiSourceBFS batch (random starts, 4 shared goals), per query
+    - hda/N             astar/N's queries with hash distributed A* (ParallelAStar) on every hardware thread
+    - batch/N           BatchSolver on 1024 A* queries, half of them to 4 shared goals, every hardware thread, per query
+    - field_serial/N, field_parallel/N   Whole BFS distance field with ParallelBFS on 1 worker / every hardware thread
+    - field_open_topdown/N, field_open_diropt/N   Same on a mostly open map, top down only / direction optimizing
+    - regions_serial/N, regions_parallel/N   ParallelDFS region labels of the open map, 1 worker / every hardware thread
+    - components_serial/N, components_parallel/N   Same labels with union-find (ComponentLabels)
+    - flowfield_bits/N, flowfield_parallel/N   FlowField of the generated maze, BitGrid BFS / ParallelBFS on every hardware thread
+    - crowd_serial/N, crowd_parallel/N   One 1/60 s step of 10000 Crowd agents walking the open map, per agent,
+                        on this thread / every hardware thread
+    - components_edit_open/N, components_edit_maze/N   ComponentLabels following single wall edits, nodes = edits
+    - replan_dstar/N, replan_astar/N   Open map, a cell of the current path walled and opened again, per replan:
+                        DStarLite repairing its plan / solveAStar from scratch
+    - heap_insert/N, heap_extract_min/N, heap_minheapify/N
+                        One heap operation on a heap holding an A* sized frontier (16 * N entries)
+*/
+
+struct BenchmarkOptions
+{
+    std::vector<unsigned int> sizes; // Grid sizes, N x N
+    unsigned int seed;
+    double minTime; // Seconds each benchmark keeps repeating for, per sample
+    unsigned int repeat; // Samples per benchmark.  Compare mode needs several for its statistics
+    std::string filter; // Only run names containing this
+    unsigned long long fixedCalls; // Calls per sample instead of running for minTime, 0 = timed
+
+    BenchmarkOptions();
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::string group; // "generator", "solver", "parallel", "field", "replan" or "heap"
+    unsigned int size;
+    unsigned long long iterations;
+    double nsPerOp; // Median of samples
+    std::vector<double> samples; // ns/op of each repeat
+    double nodesPerSecond; // Cells / nodes touched per second
+    double allocsPerOp;
+    double bytesPerOp;
+};
+
+class BenchmarkSuite
+{
+private:
+    BenchmarkOptions options;
+    std::vector<BenchmarkResult> results;
+
+    bool selected(const std::string& name) const;
+
+    // Repeats op until minTime has passed.  op returns how many nodes it processed
+    void measure(const std::string& name, const std::string& group, unsigned int size, unsigned long long opsPerCall, const std::function<unsigned long long()>& op);
+
+    void runGenerator(unsigned int size);
+    void runSolvers(unsigned int size);
+    void runFields(unsigned int size);
+    void runReplan(unsigned int size);
+    void runHeap(unsigned int size);
+
+public:
+    explicit BenchmarkSuite(const BenchmarkOptions& options);
+
+    void run();
+    void runSteadyState(); // Only the solver and heap groups, the ones checkSteadyStateAllocs() looks at
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+    const BenchmarkOptions& getOptions() const { return options; }
+
+    void printTable(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+};
+
+// Parses "64,256,1024"
+bool parseSizeList(const std::string& text, std::vector<unsigned int>& sizes);
+
+double median(std::vector<double> values);
+
+// True when every "solver" and "heap" result made zero allocations after warm up.  Offenders are listed on out
+bool checkSteadyStateAllocs(const std::vector<BenchmarkResult>& results, std::ostream& out);
+
+// The same check without the timing, for CI: the solver and heap benchmarks on one size x size maze,
+// calls times each after warm up.  Same seed, same calls, same answer on every run
+bool checkAllocs(unsigned int size, unsigned int seed, unsigned long long calls, std::ostream& out);
+
+#endif // !BENCHMARK_H
@@ -0,0 +1,299 @@
+#include "bit_grid.h"
+
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    // Lowest set bit, bits must not be 0
+    unsigned int lowestBit(std::uint64_t bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+}  // namespace
+
+const unsigned int BitGrid::UNREACHED;
+
+BitGrid::BitGrid()
+    : rows(0), cols(0), wordsPerRow(0)
+{
+}
+
+BitGrid::BitGrid(unsigned int rows, unsigned int cols, bool path)
+{
+    reset(rows, cols, path);
+}
+
+BitGrid::BitGrid(const Maze & maze)
+{
+    assign(maze);
+}
+
+void BitGrid::reset(unsigned int rows, unsigned int cols, bool path)
+{
+    this->rows = rows;
+    this->cols = cols;
+    wordsPerRow = (cols + 63) / 64;
+    open.assign(static_cast<size_t>(rows) * wordsPerRow, 0);
+    if (!path)
+        return;
+
+    // Full words, then only the real columns of the last one
+    std::uint64_t lastWord = cols % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << (cols % 64)) - 1;
+    for (unsigned int row = 0; row < rows; ++row)
+    {
+        std::uint64_t * words = &open[static_cast<size_t>(row) * wordsPerRow];
+        std::fill(words, words + wordsPerRow - 1, ~std::uint64_t(0));
+        words[wordsPerRow - 1] = lastWord;
+    }
+}
+
+void BitGrid::assign(const Maze & maze)
+{
+    reset(maze.getRows(), maze.getCols(), false);
+    const unsigned char * cells = maze.data();
+    for (unsigned int row = 0; row < rows; ++row)
+    {
+        const unsigned char * rowCells = cells + static_cast<size_t>(row) * cols;
+        std::uint64_t * words = &open[static_cast<size_t>(row) * wordsPerRow];
+        for (unsigned int col = 0; col < cols; ++col)
+            words[col / 64] |= std::uint64_t(rowCells[col] == 0) << (col % 64);
+    }
+}
+
+void BitGrid::setPath(unsigned int cell, bool path)
+{
+    if (path)
+        open[wordOf(cell)] |= bitOf(cell, cols);
+    else
+        open[wordOf(cell)] &= ~bitOf(cell, cols);
+}
+
+std::uint64_t BitGrid::fillRuns(std::uint64_t seeds, std::uint64_t mask)
+{
+    // Kogge-Stone occluded fill.  After step n every seed has spread 2^n cells, stopping at the first 0 of mask
+    std::uint64_t up = seeds;
+    std::uint64_t pass = mask;
+    up |= pass & (up << 1); pass &= pass << 1;
+    up |= pass & (up << 2); pass &= pass << 2;
+    up |= pass & (up << 4); pass &= pass << 4;
+    up |= pass & (up << 8); pass &= pass << 8;
+    up |= pass & (up << 16); pass &= pass << 16;
+    up |= pass & (up << 32);
+
+    std::uint64_t down = seeds;
+    pass = mask;
+    down |= pass & (down >> 1); pass &= pass >> 1;
+    down |= pass & (down >> 2); pass &= pass >> 2;
+    down |= pass & (down >> 4); pass &= pass >> 4;
+    down |= pass & (down >> 8); pass &= pass >> 8;
+    down |= pass & (down >> 16); pass &= pass >> 16;
+    down |= pass & (down >> 32);
+
+    return up | down;
+}
+
+void BitGrid::begin(BitScratch & scratch) const
+{
+    size_t words = open.size();
+    if (scratch.reached.size() != words) {
+        scratch.reached.assign(words, 0);
+        scratch.frontier.assign(words, 0);
+        scratch.next.assign(words, 0);
+        scratch.queued.assign(words, 0);
+        scratch.touched.clear();
+    }
+
+    // Everything else is already back to 0 by the time a query returns
+    for (unsigned int word : scratch.touched)
+        scratch.reached[word] = 0;
+    scratch.touched.clear();
+    scratch.active.clear();
+    scratch.nextActive.clear();
+}
+
+void BitGrid::markReached(BitScratch & scratch, unsigned int word, std::uint64_t bits) const
+{
+    if (scratch.reached[word] == 0)
+        scratch.touched.push_back(word);
+    scratch.reached[word] |= bits;
+}
+
+void BitGrid::floodFill(BitScratch & scratch, unsigned int start) const
+{
+    isReachable(scratch, start, cellCount());
+}
+
+bool BitGrid::isReachable(BitScratch & scratch, unsigned int start, unsigned int end) const
+{
+    begin(scratch);
+    if (start >= cellCount())
+        return false;
+
+    unsigned int endWord = end < cellCount() ? wordOf(end) : 0;
+    std::uint64_t endBit = end < cellCount() ? bitOf(end, cols) : 0;
+    std::vector<std::uint64_t>& reached = scratch.reached;
+    std::vector<unsigned int>& work = scratch.active;
+
+    // start is seeded through the mask, so its first pass counts it as added and queues its neighbors
+    unsigned int startWord = wordOf(start);
+    std::uint64_t startBit = bitOf(start, cols);
+    work.push_back(startWord);
+    scratch.queued[startWord] = 1;
+
+    // Each word pulls in what its neighbors reached, fills its open runs and queues the neighbors it can still feed
+    bool found = false;
+    while (!work.empty())
+    {
+        unsigned int word = work.back();
+        work.pop_back();
+        scratch.queued[word] = 0;
+        if (found)
+            continue; // Just draining the queued flags
+
+        unsigned int row = word / wordsPerRow;
+        unsigned int column = word % wordsPerRow;
+        std::uint64_t mask = open[word];
+        std::uint64_t seeds = reached[word];
+        if (word == startWord) {
+            mask |= startBit; // start may not be path
+            seeds |= startBit;
+        }
+        if (row > 0)
+            seeds |= reached[word - wordsPerRow] & mask;
+        if (row + 1 < rows)
+            seeds |= reached[word + wordsPerRow] & mask;
+        if (column > 0 && (reached[word - 1] >> 63))
+            seeds |= mask & 1;
+        if (column + 1 < wordsPerRow && (reached[word + 1] & 1))
+            seeds |= mask & (std::uint64_t(1) << 63);
+
+        std::uint64_t filled = fillRuns(seeds, mask);
+        std::uint64_t added = filled & ~reached[word];
+        if (!added)
+            continue;
+        markReached(scratch, word, added);
+        if (word == endWord && (filled & endBit)) {
+            found = true;
+            continue;
+        }
+
+        unsigned int neighbors[4];
+        unsigned int count = 0;
+        if (row > 0 && (added & open[word - wordsPerRow] & ~reached[word - wordsPerRow]))
+            neighbors[count++] = word - wordsPerRow;
+        if (row + 1 < rows && (added & open[word + wordsPerRow] & ~reached[word + wordsPerRow]))
+            neighbors[count++] = word + wordsPerRow;
+        if (column > 0 && (added & 1) && (open[word - 1] & ~reached[word - 1]) >> 63)
+            neighbors[count++] = word - 1;
+        if (column + 1 < wordsPerRow && (added >> 63) && (open[word + 1] & ~reached[word + 1] & 1))
+            neighbors[count++] = word + 1;
+
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (!scratch.queued[neighbors[i]]) {
+                scratch.queued[neighbors[i]] = 1;
+                work.push_back(neighbors[i]);
+            }
+        }
+    }
+    return found || (end < cellCount() && (reached[endWord] & endBit) != 0);
+}
+
+unsigned int BitGrid::layers(BitScratch & scratch, unsigned int start, unsigned int end, std::vector<unsigned int> * distance) const
+{
+    begin(scratch);
+    if (start >= cellCount())
+        return UNREACHED;
+
+    std::vector<std::uint64_t>& reached = scratch.reached;
+    std::vector<std::uint64_t>& frontier = scratch.frontier;
+    std::vector<std::uint64_t>& next = scratch.next;
+    std::vector<unsigned int>& active = scratch.active;
+    std::vector<unsigned int>& nextActive = scratch.nextActive;
+
+    unsigned int endWord = end < cellCount() ? wordOf(end) : 0;
+    std::uint64_t endBit = end < cellCount() ? bitOf(end, cols) : 0;
+    unsigned int startWord = wordOf(start);
+    markReached(scratch, startWord, bitOf(start, cols));
+    frontier[startWord] = bitOf(start, cols);
+    active.push_back(startWord);
+    if (distance)
+        (*distance)[start] = 0;
+
+    unsigned int layer = 0;
+    unsigned int result = start == end ? 0 : UNREACHED;
+    while (!active.empty() && result == UNREACHED)
+    {
+        // Every frontier word spreads one cell in each direction into next, new cells only
+        auto spread = [&](unsigned int word, std::uint64_t bits) {
+            bits &= open[word] & ~reached[word];
+            if (!bits)
+                return;
+            if (next[word] == 0)
+                nextActive.push_back(word);
+            next[word] |= bits;
+        };
+        for (unsigned int word : active)
+        {
+            unsigned int row = word / wordsPerRow;
+            unsigned int column = word % wordsPerRow;
+            std::uint64_t bits = frontier[word];
+            frontier[word] = 0;
+
+            spread(word, (bits << 1) | (bits >> 1));
+            if (column > 0 && (bits & 1))
+                spread(word - 1, std::uint64_t(1) << 63);
+            if (column + 1 < wordsPerRow && (bits >> 63))
+                spread(word + 1, 1);
+            if (row > 0)
+                spread(word - wordsPerRow, bits);
+            if (row + 1 < rows)
+                spread(word + wordsPerRow, bits);
+        }
+
+        ++layer;
+        for (unsigned int word : nextActive)
+        {
+            std::uint64_t bits = next[word];
+            next[word] = 0;
+            frontier[word] = bits;
+            markReached(scratch, word, bits);
+
+            if (distance) {
+                unsigned int first = (word / wordsPerRow) * cols + (word % wordsPerRow) * 64;
+                for (std::uint64_t rest = bits; rest; rest &= rest - 1)
+                    (*distance)[first + lowestBit(rest)] = layer;
+            }
+        }
+        if (reached[endWord] & endBit)
+            result = layer;
+        active.swap(nextActive);
+        nextActive.clear();
+    }
+
+    // Leave frontier all 0 for the next query
+    for (unsigned int word : active)
+        frontier[word] = 0;
+    return result;
+}
+
+unsigned int BitGrid::layerDistance(BitScratch & scratch, unsigned int start, unsigned int end) const
+{
+    return layers(scratch, start, end, nullptr);
+}
+
+void BitGrid::layerDistances(BitScratch & scratch, unsigned int start, std::vector<unsigned int>& distance) const
+{
+    distance.assign(cellCount(), UNREACHED);
+    layers(scratch, start, cellCount(), &distance);
+}
@@ -0,0 +1,79 @@
+#ifndef BIT_GRID_H
+#define BIT_GRID_H
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+#include "maze.h"
+
+/*
+    One bit per cell wall map: bit set = path.  Each row is wordsPerRow 64-bit words, bit i of word k is column 64k + i,
+    and the padding bits past the last column are always 0.
+
+    The searches work on whole words.  A word of the frontier spreads left / right through every open run it touches
+    with a handful of shifts and masks (Kogge-Stone fill), and up / down with one AND against the neighbor row.
+    Queries only read the grid, the scratch they need lives in a BitScratch so threads can share one BitGrid.
+*/
+
+// Per-query scratch.  Reuse it across queries, only the words a query touched are cleared by the next one
+struct BitScratch
+{
+    std::vector<std::uint64_t> reached; // Cells found by the last query.  Whole component after floodFill()
+    std::vector<std::uint64_t> frontier; // Current BFS layer
+    std::vector<std::uint64_t> next; // BFS layer being built
+    std::vector<unsigned int> touched; // Words of reached that are non zero
+    std::vector<unsigned int> active; // Words of frontier that are non zero, flood fill work list
+    std::vector<unsigned int> nextActive;
+    std::vector<unsigned char> queued; // Word is on the flood fill work list
+};
+
+class BitGrid
+{
+private:
+    unsigned int rows;
+    unsigned int cols;
+    unsigned int wordsPerRow;
+    std::vector<std::uint64_t> open; // rows * wordsPerRow
+
+    static std::uint64_t fillRuns(std::uint64_t seeds, std::uint64_t mask); // Spreads seeds over the runs of mask they touch
+
+    unsigned int wordOf(unsigned int cell) const { return (cell / cols) * wordsPerRow + (cell % cols) / 64; }
+    static std::uint64_t bitOf(unsigned int cell, unsigned int cols) { return std::uint64_t(1) << ((cell % cols) % 64); }
+
+    void begin(BitScratch& scratch) const; // Sizes scratch and clears what the last query left in it
+    void markReached(BitScratch& scratch, unsigned int word, std::uint64_t bits) const;
+
+    // BFS one layer at a time.  Returns the layer of end, or UNREACHED.  distance gets every layer when not null
+    unsigned int layers(BitScratch& scratch, unsigned int start, unsigned int end, std::vector<unsigned int> * distance) const;
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+
+    //Constructors
+    BitGrid();
+    BitGrid(unsigned int rows, unsigned int cols, bool path); // Every cell path, or every cell wall
+    explicit BitGrid(const Maze& maze);
+
+    void assign(const Maze& maze);
+    void reset(unsigned int rows, unsigned int cols, bool path);
+
+    //Accessors
+    unsigned int getRows() const { return rows; }
+    unsigned int getCols() const { return cols; }
+    unsigned int getWordsPerRow() const { return wordsPerRow; }
+    unsigned int cellCount() const { return rows * cols; }
+    bool isPath(unsigned int cell) const { return (open[wordOf(cell)] & bitOf(cell, cols)) != 0; }
+    void setPath(unsigned int cell, bool path);
+
+    // The start cell always counts as open, like Graph where start isn't marked as path.
+    // After any of these, scratch.reached holds every cell they found
+    void floodFill(BitScratch& scratch, unsigned int start) const; // Whole component of start
+    bool isReachable(BitScratch& scratch, unsigned int start, unsigned int end) const; // Stops once end is found
+    unsigned int layerDistance(BitScratch& scratch, unsigned int start, unsigned int end) const; // BFS moves to end, or UNREACHED
+
+    // BFS depth of every cell, UNREACHED where start can't get to.  distance is resized to cellCount()
+    void layerDistances(BitScratch& scratch, unsigned int start, std::vector<unsigned int>& distance) const;
+};
+
+#endif // !BIT_GRID_H
@@ -0,0 +1,951 @@
+#include "cli.h"
+#include "solver.h"
+#include "thread_pool.h"
+#include "benchmark.h"
+#include "bench_compare.h"
+#include "movingai.h"
+#include "solve_server.h"
+#include "solve_client.h"
+#include "shared_maze.h"
+#include "path_cache.h"
+#include "search_context.h"
+#include "parallel_astar.h"
+#include "parallel_dfs.h"
+#include "component_labels.h"
+#include "batch_solver.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <algorithm>
+#include <csignal>
+#include <thread>
+
+namespace {
+
+    void printUsage(std::ostream& out)
+    {
+        out << "Usage:\n" <<
+            "  mazefinder                      Interactive window (asks for GridSize and BlockSize)\n" <<
+            "  mazefinder solve [options]      Solve queries headless, CSV results\n" <<
+            "      --size N          Generate an N x N maze (default 64)\n" <<
+            "      --seed S          Generator / random query seed (default: time)\n" <<
+            "      --load FILE       Load a maze file instead of generating one\n" <<
+            "      --algo NAME       bfs, dfs or astar (default astar)\n" <<
+            "      --queries FILE    \"startRow startCol endRow endCol\" per line\n" <<
+            "      --count N         Random queries when there is no --queries (default 100)\n" <<
+            "      --out FILE        Results CSV (default stdout)\n" <<
+            "      --threads T       Worker threads (default: hardware threads)\n" <<
+            "      --shm NAME        Solve on a maze shared by \"publish\" instead of --size / --load\n" <<
+            "                        A query that races edits on every retry is left out, exit code 1\n" <<
+            "      --cache-mb M      LRU cache of results for repeated queries, M megabytes (default 0, off)\n" <<
+            "      --hda             A* only: one query at a time, each spread over every thread (hash distributed A*)\n" <<
+            "  mazefinder batch [options]      Solve a whole batch of queries at once, CSV results in query order\n" <<
+            "      --size N, --seed S, --load FILE, --algo NAME, --queries FILE, --count N, --out FILE, --threads T   As for solve\n" <<
+            "      --goals K         Random queries share K ends (default 0, every end random)\n" <<
+            "  mazefinder generate [options]   Write a generated maze to --out\n" <<
+            "      --size N, --seed S, --out FILE\n" <<
+            "  mazefinder analyze [options]    Regions, reachable cells and dead ends (work stealing DFS)\n" <<
+            "      --size N, --seed S, --load FILE   Maze, as for solve\n" <<
+            "      --row R --col C   Start cell (default: first cell of the largest region)\n" <<
+            "      --threads T       Worker threads (default: hardware threads)\n" <<
+            "  mazefinder bench [options]      Headless microbenchmarks\n" <<
+            "      --sizes LIST      Grid sizes (default 64,128,256,512,1024,2048,4096,8192)\n" <<
+            "      --seed S          Fixed seed (default 7)\n" <<
+            "      --min-time SEC    Time per sample (default 0.2)\n" <<
+            "      --repeat N        Samples per benchmark (default 5)\n" <<
+            "      --filter TEXT     Only benchmarks whose name contains TEXT\n" <<
+            "      --json FILE       Also write results as JSON (\"-\" for stdout)\n" <<
+            "      --baseline FILE   Compare against a stored --json run, exit 1 on regression\n" <<
+            "      --threshold R     Slowdown that counts as a regression (default 0.10)\n" <<
+            "      --alpha A         Significance level of the Mann-Whitney test (default 0.05)\n" <<
+            "      --check-allocs    Exit 1 if a solver or heap benchmark allocates once warmed up\n" <<
+            "  mazefinder check-allocs [opts]  Quick allocation check for CI, exit 1 if a solver or heap op allocates\n" <<
+            "      --size N          One N x N maze (default 64)\n" <<
+            "      --seed S          Fixed seed (default 7)\n" <<
+            "      --calls C         Calls per benchmark after warm up (default 64)\n" <<
+            "  mazefinder scen [options]       Run a Moving AI .scen file, per bucket timing\n" <<
+            "      --scen FILE       Scenario list\n" <<
+            "      --map FILE        Octile .map (default: the scenario's map next to the .scen)\n" <<
+            "      --algo NAME       astar8 (octile, checked exactly), astar, bfs or dfs (default astar8)\n" <<
+            "      --out FILE        Per scenario CSV\n" <<
+            "  mazefinder serve [options]      Keep mazes resident and answer solve requests over TCP\n" <<
+            "      --load LIST       Comma separated maze files (ids 0, 1, ...)\n" <<
+            "      --mazes K         Also generate K mazes of --size N from seeds S, S+1, ... (default 1 if nothing loaded)\n" <<
+            "      --port P          Port (default 47000)\n" <<
+            "      --bind ADDR       Interface (default 127.0.0.1)\n" <<
+            "      --threads T       Worker threads (default: hardware threads)\n" <<
+            "      --cache-mb M      LRU result cache, M megabytes (default 0, off)\n" <<
+            "  mazefinder client [options]     Test client for serve\n" <<
+            "      --host ADDR, --port P, --maze ID, --algo NAME\n" <<
+            "      --queries FILE | --count N   Queries (default 1000 random)\n" <<
+            "      --batch B         Requests per batch (default 64)\n" <<
+            "      --pipeline D      Batches in flight (default 4)\n" <<
+            "      --out FILE        Reply CSV\n" <<
+            "  mazefinder publish [options]    Share a maze in named shared memory until Ctrl+C\n" <<
+            "      --name NAME       Segment name\n" <<
+            "      --size N, --seed S, --load FILE   Maze, as for solve\n" <<
+            "      --edit-ms MS      Toggle a random inner cell every MS milliseconds (default 0, never)\n" <<
+            "  mazefinder help\n";
+    }
+
+    int cmdGenerate(const CliArgs& args)
+    {
+        std::string error;
+        Maze maze;
+        if (!loadOrGenerateMaze(args, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        if (!args.has("out")) {
+            std::cerr << "ERROR: generate needs --out FILE\n";
+            return 2;
+        }
+        if (!maze.saveToFile(args.getString("out", ""))) {
+            std::cerr << "ERROR: Could not write " << args.getString("out", "") << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    int cmdAnalyze(const CliArgs& args)
+    {
+        std::string error;
+        Maze maze;
+        if (!loadOrGenerateMaze(args, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        ThreadPool pool(args.getUnsigned("threads", 0));
+        ParallelDFS dfs(pool);
+        auto begin = std::chrono::steady_clock::now();
+
+        std::vector<unsigned int> labels;
+        unsigned int regions = dfs.labelRegions(maze, labels);
+        std::vector<unsigned int> sizes(maze.cellCount(), 0);
+        unsigned int largest = ParallelDFS::NO_REGION;
+        for (unsigned int label : labels)
+        {
+            if (label == ParallelDFS::NO_REGION)
+                continue;
+            ++sizes[label];
+            if (largest == ParallelDFS::NO_REGION || sizes[label] > sizes[largest] || (sizes[label] == sizes[largest] && label < largest))
+                largest = label;
+        }
+
+        unsigned int start = largest;
+        if (args.has("row") || args.has("col")) {
+            unsigned int row = args.getUnsigned("row", 0);
+            unsigned int col = args.getUnsigned("col", 0);
+            if (row >= maze.getRows() || col >= maze.getCols()) {
+                std::cerr << "ERROR: --row / --col outside the maze\n";
+                return 2;
+            }
+            start = maze.index(row, col);
+        }
+
+        std::cout << "regions: " << regions << '\n';
+        if (largest != ParallelDFS::NO_REGION)
+            std::cout << "largest_region: " << sizes[largest] << " cells from " << maze.rowOf(largest) << ',' << maze.colOf(largest) << '\n';
+        if (start != ParallelDFS::NO_REGION && maze.isPath(start)) {
+            std::vector<unsigned int> deadEnds;
+            dfs.deadEnds(maze, start, deadEnds);
+            std::cout << "start: " << maze.rowOf(start) << ',' << maze.colOf(start) << '\n' <<
+                "reachable: " << dfs.countReachable(maze, start) << '\n' <<
+                "dead_ends: " << deadEnds.size() << '\n';
+        }
+        else {
+            std::cout << "reachable: 0\n";
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cerr << seconds << " s, " << pool.size() << " threads\n";
+        return 0;
+    }
+
+    int cmdSolve(const CliArgs& args)
+    {
+        std::string error;
+        Maze maze;
+        SharedMazeReader shared;
+        bool useShared = args.has("shm");
+        if (useShared) {
+            if (!shared.attach(args.getString("shm", ""), error)) {
+                std::cerr << "ERROR: " << error << '\n';
+                return 1;
+            }
+            maze = shared.getMaze();
+        }
+        else if (!loadOrGenerateMaze(args, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        Algorithm algo;
+        if (!parseAlgorithm(args.getString("algo", "astar"), algo)) {
+            std::cerr << "ERROR: Unknown --algo " << args.getString("algo", "") << '\n';
+            return 2;
+        }
+
+        std::vector<Query> queries;
+        if (args.has("queries")) {
+            if (!loadQueries(args.getString("queries", ""), maze, queries, error)) {
+                std::cerr << "ERROR: " << error << '\n';
+                return 1;
+            }
+        }
+        else {
+            unsigned int seed = args.getUnsigned("seed", static_cast<unsigned int>(time(0)));
+            randomQueries(maze, args.getUnsigned("count", 100), seed + 1, queries);
+        }
+
+        std::ofstream outFile;
+        std::ostream * out = &std::cout;
+        std::string outName = args.getString("out", "-");
+        if (outName != "-") {
+            outFile.open(outName);
+            if (!outFile.is_open()) {
+                std::cerr << "ERROR: Could not write " << outName << '\n';
+                return 1;
+            }
+            out = &outFile;
+        }
+
+        *out << "id,algo,start_row,start_col,end_row,end_col,found,length,expanded,micros\n";
+
+        // Huge one-off queries: all threads work on the same query instead of one query per thread
+        if (args.has("hda")) {
+            if (algo != Algorithm::AStar) {
+                std::cerr << "ERROR: --hda needs --algo astar\n";
+                return 2;
+            }
+            ThreadPool pool(args.getUnsigned("threads", 0));
+            ParallelAStar hda(pool);
+            ComponentLabels components;
+            components.build(maze, pool);
+            unsigned int foundCount = 0;
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < queries.size(); ++i)
+            {
+                const Query& query = queries[i];
+                auto solveBegin = std::chrono::steady_clock::now();
+                SolveResult result = { false, 0, 0 };
+                if (components.connected(query.start, query.end))
+                    result = hda.solve(maze, query.start, query.end);
+                auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - solveBegin).count();
+                *out << i << ",hda," <<
+                    maze.rowOf(query.start) << ',' << maze.colOf(query.start) << ',' <<
+                    maze.rowOf(query.end) << ',' << maze.colOf(query.end) << ',' <<
+                    (result.found ? 1 : 0) << ',' << result.pathLength << ',' << result.expanded << ',' << micros << '\n';
+                if (result.found)
+                    ++foundCount;
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            std::cerr << queries.size() << " queries, " << foundCount << " found, " <<
+                seconds << " s, " << pool.size() << " threads per query\n";
+            return 0;
+        }
+
+        // A shared maze can change under us, and the view's hash doesn't follow the publisher's edits
+        std::unique_ptr<PathCache> cache;
+        unsigned int cacheMb = args.getUnsigned("cache-mb", 0);
+        if (cacheMb > 0 && !useShared)
+            cache.reset(new PathCache(static_cast<std::size_t>(cacheMb) << 20));
+
+        // Results are written as they finish, so lines are not in id order
+        std::mutex outMutex;
+        unsigned int foundCount = 0;
+        unsigned int tornCount = 0; // --shm queries that raced edits on every retry, no line written
+        ThreadPool pool(args.getUnsigned("threads", 0));
+        std::vector<SearchContext> contexts(pool.size()); // One per worker, the maze is shared read only
+
+        // Queries between components fail without a search.  A shared maze can be edited under us, so not for --shm
+        ComponentLabels components;
+        if (!useShared)
+            components.build(maze, pool);
+        auto begin = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            pool.enqueue([&, i](unsigned int worker) {
+                const Query& query = queries[i];
+                auto solveBegin = std::chrono::steady_clock::now();
+                SearchContext& context = contexts[worker];
+                SolveResult result = { false, 0, 0 };
+                if (useShared) {
+                    if (!shared.solveConsistent(context, algo, query.start, query.end, result)) {
+                        std::lock_guard<std::mutex> lock(outMutex);
+                        std::cerr << "query " << i << ": the shared maze kept changing, no consistent answer\n";
+                        ++tornCount;
+                        return;
+                    }
+                }
+                else if (components.connected(query.start, query.end))
+                    result = solveCached(cache.get(), maze, context, algo, query.start, query.end);
+                auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - solveBegin).count();
+
+                std::ostringstream line;
+                line << i << ',' << algorithmName(algo) << ',' <<
+                    maze.rowOf(query.start) << ',' << maze.colOf(query.start) << ',' <<
+                    maze.rowOf(query.end) << ',' << maze.colOf(query.end) << ',' <<
+                    (result.found ? 1 : 0) << ',' << result.pathLength << ',' << result.expanded << ',' << micros << '\n';
+
+                std::lock_guard<std::mutex> lock(outMutex);
+                *out << line.str() << std::flush;
+                if (result.found)
+                    ++foundCount;
+            });
+        }
+        pool.wait();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cerr << queries.size() << " queries, " << foundCount << " found, " <<
+            seconds << " s, " << (seconds > 0 ? queries.size() / seconds : 0.0) << " queries/s, " <<
+            pool.size() << " threads\n";
+        if (cache) {
+            PathCacheStats stats = cache->getStats();
+            std::cerr << "cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions <<
+                " evictions, " << cache->size() << " entries, " << cache->bytes() << " bytes\n";
+        }
+        if (tornCount > 0) {
+            std::cerr << "ERROR: " << tornCount << " queries had no consistent answer and were left out\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    int cmdBatch(const CliArgs& args)
+    {
+        std::string error;
+        Maze maze;
+        if (!loadOrGenerateMaze(args, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        Algorithm algo;
+        if (!parseAlgorithm(args.getString("algo", "astar"), algo)) {
+            std::cerr << "ERROR: Unknown --algo " << args.getString("algo", "") << '\n';
+            return 2;
+        }
+
+        std::vector<Query> queries;
+        if (args.has("queries")) {
+            if (!loadQueries(args.getString("queries", ""), maze, queries, error)) {
+                std::cerr << "ERROR: " << error << '\n';
+                return 1;
+            }
+        }
+        else {
+            unsigned int seed = args.getUnsigned("seed", static_cast<unsigned int>(time(0)));
+            randomQueries(maze, args.getUnsigned("count", 1000), seed + 1, queries);
+
+            // Many units heading for a few targets
+            unsigned int goalCount = args.getUnsigned("goals", 0);
+            if (goalCount > 0) {
+                std::mt19937 random(seed + 2);
+                std::vector<unsigned int> goals;
+                for (unsigned int i = 0; i < goalCount; ++i)
+                    goals.push_back(maze.randomPathCell(random));
+                for (size_t i = 0; i < queries.size(); ++i)
+                    queries[i].end = goals[i % goalCount];
+            }
+        }
+
+        std::ofstream outFile;
+        std::ostream * out = &std::cout;
+        std::string outName = args.getString("out", "-");
+        if (outName != "-") {
+            outFile.open(outName);
+            if (!outFile.is_open()) {
+                std::cerr << "ERROR: Could not write " << outName << '\n';
+                return 1;
+            }
+            out = &outFile;
+        }
+
+        ThreadPool pool(args.getUnsigned("threads", 0));
+        BatchSolver solver(pool);
+        auto begin = std::chrono::steady_clock::now();
+        ComponentLabels components;
+        components.build(maze, pool);
+        std::vector<SolveResult> results;
+        BatchStats stats = solver.solve(maze, algo, queries, results, &components);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        *out << "id,algo,start_row,start_col,end_row,end_col,found,length,expanded\n";
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            const Query& query = queries[i];
+            const SolveResult& result = results[i];
+            *out << i << ',' << algorithmName(algo) << ',' <<
+                maze.rowOf(query.start) << ',' << maze.colOf(query.start) << ',' <<
+                maze.rowOf(query.end) << ',' << maze.colOf(query.end) << ',' <<
+                (result.found ? 1 : 0) << ',' << result.pathLength << ',' << result.expanded << '\n';
+        }
+
+        std::cerr << stats.queries << " queries, " << stats.found << " found, " <<
+            stats.unreachable << " unreachable, " << stats.shared << " shared in " << stats.traversals << " traversals, " <<
+            stats.searched << " searched (" << stats.expanded << " expanded)\n" <<
+            stats.seconds << " s solving, " << stats.queriesPerSecond() << " queries/s, " <<
+            seconds << " s with component labels, " << pool.size() << " threads\n";
+        return 0;
+    }
+
+    // "-" is stdout.  False, with a message, when the file couldn't be written
+    bool writeBenchJson(const BenchmarkSuite& suite, const std::string& jsonName)
+    {
+        if (jsonName == "-") {
+            suite.writeJson(std::cout);
+            return true;
+        }
+
+        std::ofstream jsonFile(jsonName);
+        if (jsonFile.is_open())
+            suite.writeJson(jsonFile);
+        if (!jsonFile.is_open() || !jsonFile.flush()) {
+            std::cerr << "ERROR: Could not write " << jsonName << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    int cmdBench(const CliArgs& args)
+    {
+        BenchmarkOptions options;
+        std::vector<BaselineEntry> baseline;
+        std::string error;
+
+        // Baseline settings first so the command line can still override them
+        if (args.has("baseline") && !loadBaseline(args.getString("baseline", ""), baseline, options, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 2;
+        }
+
+        if (args.has("sizes") && !parseSizeList(args.getString("sizes", ""), options.sizes)) {
+            std::cerr << "ERROR: --sizes expects a comma separated list of sizes >= 4\n";
+            return 2;
+        }
+        options.seed = args.getUnsigned("seed", options.seed);
+        options.minTime = args.getDouble("min-time", options.minTime);
+        options.repeat = args.getUnsigned("repeat", options.repeat);
+        options.filter = args.getString("filter", "");
+
+        BenchmarkSuite suite(options);
+        suite.run();
+
+        // Solvers and heap must not touch operator new once warm, --check-allocs turns that into the exit code
+        int status = 0;
+        if (args.has("check-allocs") && !checkSteadyStateAllocs(suite.getResults(), std::cerr))
+            status = 1;
+
+        if (args.has("baseline")) {
+            // Benchmarks left out by --filter are not missing
+            baseline.erase(std::remove_if(baseline.begin(), baseline.end(), [&](const BaselineEntry& entry) {
+                return entry.name.find(options.filter) == std::string::npos;
+            }), baseline.end());
+
+            CompareOptions compareOptions;
+            compareOptions.threshold = args.getDouble("threshold", compareOptions.threshold);
+            compareOptions.alpha = args.getDouble("alpha", compareOptions.alpha);
+
+            // With --json - stdout is only the JSON, the comparison moves to stderr
+            std::string jsonName = args.getString("json", "");
+            std::vector<Comparison> comparisons = compareResults(baseline, suite.getResults(), compareOptions);
+            printComparison(jsonName == "-" ? std::cerr : std::cout, comparisons);
+            if (!jsonName.empty() && !writeBenchJson(suite, jsonName))
+                return 1;
+
+            if (hasRegression(comparisons)) {
+                std::cerr << "Performance regression against " << args.getString("baseline", "") << '\n';
+                return 1;
+            }
+            return status;
+        }
+
+        std::string jsonName = args.getString("json", "");
+        if (jsonName != "-")
+            suite.printTable(std::cout);
+        if (!jsonName.empty() && !writeBenchJson(suite, jsonName))
+            return 1;
+        return status;
+    }
+
+    int cmdCheckAllocs(const CliArgs& args)
+    {
+        unsigned int size = args.getUnsigned("size", 64);
+        if (size < 4) {
+            std::cerr << "ERROR: --size must be at least 4\n";
+            return 2;
+        }
+        BenchmarkOptions defaults;
+        return checkAllocs(size, args.getUnsigned("seed", defaults.seed), args.getUnsigned("calls", 64), std::cout) ? 0 : 1;
+    }
+
+    int cmdScen(const CliArgs& args)
+    {
+        std::string error;
+        std::vector<Scenario> scenarios;
+        std::string scenName = args.getString("scen", "");
+        if (scenName.empty()) {
+            std::cerr << "ERROR: scen needs --scen FILE\n";
+            return 2;
+        }
+        if (!loadScenarios(scenName, scenarios, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+        if (scenarios.empty()) {
+            std::cerr << "ERROR: " << scenName << " has no scenarios\n";
+            return 1;
+        }
+
+        // Scenario map names carry the benchmark's directory layout, so look next to the .scen
+        std::string mapName = args.getString("map", "");
+        if (mapName.empty()) {
+            std::string base = scenarios[0].mapName.substr(scenarios[0].mapName.find_last_of("/\\") + 1);
+            size_t slash = scenName.find_last_of("/\\");
+            mapName = (slash == std::string::npos ? "" : scenName.substr(0, slash + 1)) + base;
+        }
+
+        Maze maze;
+        if (!loadMovingAIMap(mapName, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        std::string algoName = args.getString("algo", "astar8");
+        Algorithm algo;
+        if (algoName != "astar8" && !parseAlgorithm(algoName, algo)) {
+            std::cerr << "ERROR: Unknown --algo " << algoName << '\n';
+            return 2;
+        }
+
+        std::ofstream csvFile;
+        if (args.has("out")) {
+            csvFile.open(args.getString("out", ""));
+            if (!csvFile.is_open()) {
+                std::cerr << "ERROR: Could not write " << args.getString("out", "") << '\n';
+                return 1;
+            }
+        }
+
+        std::vector<BucketStats> buckets;
+        bool ok = runScenarios(maze, scenarios, algoName, buckets, csvFile.is_open() ? &csvFile : nullptr);
+        std::cout << mapName << ": " << maze.getCols() << " x " << maze.getRows() << ", " <<
+            scenarios.size() << " scenarios, " << algoName << '\n';
+        printBuckets(std::cout, buckets);
+
+        if (!ok) {
+            std::cerr << "Some path lengths did not match the reference\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    SolveServer * activeServer = nullptr;
+
+    void stopServer(int)
+    {
+        if (activeServer)
+            activeServer->stop();
+    }
+
+    int cmdServe(const CliArgs& args)
+    {
+        std::vector<Maze> mazes;
+        std::stringstream loadList(args.getString("load", ""));
+        std::string fname;
+        while (std::getline(loadList, fname, ','))
+        {
+            Maze maze;
+            if (fname.empty())
+                continue;
+            if (!maze.loadFromFile(fname)) {
+                std::cerr << "ERROR: Could not load maze " << fname << '\n';
+                return 1;
+            }
+            mazes.push_back(std::move(maze));
+        }
+
+        unsigned int generated = args.getUnsigned("mazes", mazes.empty() ? 1 : 0);
+        unsigned int size = args.getUnsigned("size", 64);
+        unsigned int seed = args.getUnsigned("seed", static_cast<unsigned int>(time(0)));
+        if (generated > 0 && size < 4) {
+            std::cerr << "ERROR: --size must be at least 4\n";
+            return 2;
+        }
+        for (unsigned int i = 0; i < generated; ++i)
+        {
+            Maze maze(size);
+            maze.generate(seed + i);
+            mazes.push_back(std::move(maze));
+        }
+
+        size_t mazeCount = mazes.size();
+        SolveServer server(std::move(mazes), args.getUnsigned("threads", 0), static_cast<std::size_t>(args.getUnsigned("cache-mb", 0)) << 20);
+        std::string error;
+        unsigned short port = static_cast<unsigned short>(args.getUnsigned("port", SolveProtocol::DEFAULT_PORT));
+        if (!server.start(port, args.getString("bind", "127.0.0.1"), error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cerr << "Serving " << mazeCount << " maze(s) on port " << port << ", Ctrl+C to stop\n";
+
+        server.run();
+
+        activeServer = nullptr;
+        std::cerr << server.getSolvedCount() << " requests solved\n";
+        if (server.getCache()) {
+            PathCacheStats stats = server.getCache()->getStats();
+            std::cerr << "cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions\n";
+        }
+        return 0;
+    }
+
+    volatile std::sig_atomic_t publishStop = 0;
+
+    void stopPublish(int)
+    {
+        publishStop = 1;
+    }
+
+    int cmdPublish(const CliArgs& args)
+    {
+        std::string name = args.getString("name", "");
+        if (name.empty()) {
+            std::cerr << "ERROR: publish needs --name NAME\n";
+            return 2;
+        }
+
+        std::string error;
+        Maze maze;
+        if (!loadOrGenerateMaze(args, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        SharedMazePublisher publisher;
+        if (!publisher.publish(name, maze, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        publishStop = 0;
+        std::signal(SIGINT, stopPublish);
+        std::signal(SIGTERM, stopPublish);
+        std::cerr << "Published " << maze.getRows() << 'x' << maze.getCols() << " maze as " << name << ", Ctrl+C to stop\n";
+
+        // Optional live edits so readers can be tested against a changing maze
+        unsigned int editMs = args.getUnsigned("edit-ms", 0);
+        std::mt19937 random(args.getUnsigned("seed", 0) + 2);
+        while (!publishStop)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(editMs ? editMs : 100));
+            if (editMs == 0 || maze.getRows() < 3 || maze.getCols() < 3)
+                continue;
+
+            unsigned int row = 1 + random() % (maze.getRows() - 2);
+            unsigned int col = 1 + random() % (maze.getCols() - 2);
+            bool wall = !maze.isWall(maze.index(row, col));
+            maze.setWall(row, col, wall);
+            publisher.setWall(row, col, wall);
+        }
+
+        std::cerr << publisher.getHeader()->generation.load() << " edits published\n";
+        publisher.unpublish();
+        return 0;
+    }
+
+    int cmdClient(const CliArgs& args)
+    {
+        std::string error;
+        SolveClient client;
+        unsigned short port = static_cast<unsigned short>(args.getUnsigned("port", SolveProtocol::DEFAULT_PORT));
+        if (!client.connect(args.getString("host", "127.0.0.1"), port, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        std::vector<std::pair<unsigned int, unsigned int>> sizes;
+        if (!client.mazeInfo(sizes, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+        unsigned int mazeId = args.getUnsigned("maze", 0);
+        if (mazeId >= sizes.size()) {
+            std::cerr << "ERROR: Server has " << sizes.size() << " maze(s), no id " << mazeId << '\n';
+            return 2;
+        }
+
+        Algorithm algo;
+        if (!parseAlgorithm(args.getString("algo", "astar"), algo)) {
+            std::cerr << "ERROR: Unknown --algo " << args.getString("algo", "") << '\n';
+            return 2;
+        }
+
+        // Only the bounds are known here, so a same-sized empty Maze does the query parsing
+        Maze bounds(sizes[mazeId].first, sizes[mazeId].second);
+        std::vector<Query> queries;
+        if (args.has("queries")) {
+            if (!loadQueries(args.getString("queries", ""), bounds, queries, error)) {
+                std::cerr << "ERROR: " << error << '\n';
+                return 1;
+            }
+        }
+        else
+            randomQueries(bounds, args.getUnsigned("count", 1000), args.getUnsigned("seed", static_cast<unsigned int>(time(0))), queries);
+
+        std::vector<SolveProtocol::Request> requests;
+        requests.reserve(queries.size());
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            SolveProtocol::Request request;
+            request.requestId = static_cast<sf::Uint32>(i);
+            request.mazeId = mazeId;
+            request.startRow = bounds.rowOf(queries[i].start);
+            request.startCol = bounds.colOf(queries[i].start);
+            request.endRow = bounds.rowOf(queries[i].end);
+            request.endCol = bounds.colOf(queries[i].end);
+            request.algo = static_cast<sf::Uint8>(algo);
+            requests.push_back(request);
+        }
+
+        std::ofstream csvFile;
+        if (args.has("out")) {
+            csvFile.open(args.getString("out", ""));
+            if (!csvFile.is_open()) {
+                std::cerr << "ERROR: Could not write " << args.getString("out", "") << '\n';
+                return 1;
+            }
+        }
+
+        ClientRunStats stats;
+        if (!runClientLoad(client, requests, args.getUnsigned("batch", 64), args.getUnsigned("pipeline", 4),
+            stats, csvFile.is_open() ? &csvFile : nullptr, error)) {
+            std::cerr << "ERROR: " << error << '\n';
+            return 1;
+        }
+
+        std::cout << stats.requests << " requests, " << stats.found << " found, " << stats.seconds << " s, " <<
+            (stats.seconds > 0 ? stats.requests / stats.seconds : 0.0) << " requests/s, batch latency p50 " <<
+            stats.batchLatencyP50 << " us, p99 " << stats.batchLatencyP99 << " us\n";
+        if (stats.rejectedBatches > 0) {
+            std::cerr << "ERROR: " << stats.rejectedBatches << " batch(es) rejected.  Last: " << error << '\n';
+            return 1;
+        }
+        return 0;
+    }
+
+    // Options each command reads, the maze ones through loadOrGenerateMaze
+    bool knownOptions(const std::string& command, std::vector<std::string>& known)
+    {
+        static const std::map<std::string, std::vector<std::string>> table = {
+            { "solve", { "size", "seed", "load", "algo", "queries", "count", "out", "threads", "shm", "cache-mb", "hda" } },
+            { "batch", { "size", "seed", "load", "algo", "queries", "count", "goals", "out", "threads" } },
+            { "generate", { "size", "seed", "load", "out" } },
+            { "analyze", { "size", "seed", "load", "row", "col", "threads" } },
+            { "bench", { "sizes", "seed", "min-time", "repeat", "filter", "json", "baseline", "threshold", "alpha", "check-allocs" } },
+            { "check-allocs", { "size", "seed", "calls" } },
+            { "scen", { "scen", "map", "algo", "out" } },
+            { "serve", { "load", "mazes", "size", "seed", "port", "bind", "threads", "cache-mb" } },
+            { "client", { "host", "port", "maze", "algo", "queries", "count", "seed", "batch", "pipeline", "out" } },
+            { "publish", { "name", "size", "seed", "load", "edit-ms" } }
+        };
+        auto it = table.find(command);
+        if (it == table.end())
+            return false;
+        known = it->second;
+        return true;
+    }
+
+}  // namespace
+
+bool CliArgs::parse(int argc, char * argv[], int first, std::string & error)
+{
+    for (int i = first; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.size() < 3 || arg.compare(0, 2, "--") != 0) {
+            error = "Unexpected argument " + arg;
+            return false;
+        }
+
+        std::string key = arg.substr(2);
+        if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+            options[key] = argv[++i];
+        else
+            options[key] = ""; // Flag
+    }
+    return true;
+}
+
+bool CliArgs::has(const std::string & key) const
+{
+    return options.find(key) != options.end();
+}
+
+bool CliArgs::allKnown(const std::vector<std::string>& known, std::string & error) const
+{
+    for (const auto& option : options)
+    {
+        if (std::find(known.begin(), known.end(), option.first) == known.end()) {
+            error = "Unknown option --" + option.first;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string CliArgs::getString(const std::string & key, const std::string & fallback) const
+{
+    auto it = options.find(key);
+    return it != options.end() ? it->second : fallback;
+}
+
+unsigned int CliArgs::getUnsigned(const std::string & key, unsigned int fallback) const
+{
+    auto it = options.find(key);
+    if (it == options.end() || it->second.empty())
+        return fallback;
+    return static_cast<unsigned int>(std::strtoul(it->second.c_str(), nullptr, 10));
+}
+
+double CliArgs::getDouble(const std::string & key, double fallback) const
+{
+    auto it = options.find(key);
+    if (it == options.end() || it->second.empty())
+        return fallback;
+    return std::strtod(it->second.c_str(), nullptr);
+}
+
+bool loadOrGenerateMaze(const CliArgs & args, Maze & maze, std::string & error)
+{
+    if (args.has("load")) {
+        if (!maze.loadFromFile(args.getString("load", ""))) {
+            error = "Could not load maze " + args.getString("load", "");
+            return false;
+        }
+        return true;
+    }
+
+    unsigned int size = args.getUnsigned("size", 64);
+    if (size < 4) {
+        error = "--size must be at least 4";
+        return false;
+    }
+    maze = Maze(size);
+    maze.generate(args.getUnsigned("seed", static_cast<unsigned int>(time(0))));
+    return true;
+}
+
+bool loadQueries(const std::string & fname, const Maze & maze, std::vector<Query>& queries, std::string & error)
+{
+    std::ifstream file(fname);
+    if (!file.is_open()) {
+        error = "Could not open queries " + fname;
+        return false;
+    }
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        unsigned int startRow, startCol, endRow, endCol;
+        if (!(ss >> startRow >> startCol >> endRow >> endCol)
+            || !maze.inBounds(startRow, startCol) || !maze.inBounds(endRow, endCol)) {
+            error = fname + ":" + std::to_string(lineNumber) + ": expected \"startRow startCol endRow endCol\" inside the maze";
+            return false;
+        }
+        queries.push_back({ maze.index(startRow, startCol), maze.index(endRow, endCol) });
+    }
+    return true;
+}
+
+void randomQueries(const Maze & maze, unsigned int count, unsigned int seed, std::vector<Query>& queries)
+{
+    std::mt19937 random(seed);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int start = maze.randomPathCell(random);
+        unsigned int end = maze.randomPathCell(random);
+        if (start >= maze.cellCount() || end >= maze.cellCount())
+            return; // No path cells at all
+        queries.push_back({ start, end });
+    }
+}
+
+int runCli(int argc, char * argv[])
+{
+    std::string command = argv[1];
+    if (command == "help" || command == "--help" || command == "-h") {
+        printUsage(std::cout);
+        return 0;
+    }
+
+    CliArgs args;
+    std::string error;
+    if (!args.parse(argc, argv, 2, error)) {
+        std::cerr << "ERROR: " << error << '\n';
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::vector<std::string> known;
+    if (!knownOptions(command, known)) {
+        std::cerr << "ERROR: Unknown command " << command << '\n';
+        printUsage(std::cerr);
+        return 2;
+    }
+    if (args.has("help")) {
+        printUsage(std::cout);
+        return 0;
+    }
+    if (!args.allKnown(known, error)) {
+        std::cerr << "ERROR: " << error << " for " << command << '\n';
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    if (command == "solve")
+        return cmdSolve(args);
+    else if (command == "batch")
+        return cmdBatch(args);
+    else if (command == "generate")
+        return cmdGenerate(args);
+    else if (command == "analyze")
+        return cmdAnalyze(args);
+    else if (command == "bench")
+        return cmdBench(args);
+    else if (command == "check-allocs")
+        return cmdCheckAllocs(args);
+    else if (command == "scen")
+        return cmdScen(args);
+    else if (command == "serve")
+        return cmdServe(args);
+    else if (command == "client")
+        return cmdClient(args);
+    else if (command == "publish")
+        return cmdPublish(args);
+
+    std::cerr << "ERROR: Unknown command " << command << '\n';
+    printUsage(std::cerr);
+    return 2;
+}
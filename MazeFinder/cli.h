@@ -0,0 +1,58 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "maze.h"
+#include "solver.h"
+
+/*
+    Non-interactive command line.  No window, no audio, no prompts.
+
+    mazefinder solve    [--size N | --load maze.txt] [--seed S] [--algo bfs|dfs|astar]
+                        [--queries q.txt | --count N] [--out results.csv] [--threads T] [--shm NAME] [--cache-mb M]
+    mazefinder batch    [--size N | --load maze.txt] [--seed S] [--algo bfs|dfs|astar]
+                        [--queries q.txt | --count N [--goals K]] [--out results.csv] [--threads T]
+    mazefinder generate [--size N] [--seed S] --out maze.txt
+    mazefinder analyze  [--size N | --load maze.txt] [--seed S] [--row R --col C] [--threads T]
+    mazefinder bench    [--sizes 64,256,...] [--seed S] [--min-time SEC] [--repeat N] [--filter TEXT] [--json FILE]
+                        [--baseline base.json [--threshold 0.10] [--alpha 0.05]]
+    mazefinder scen     --scen file.scen [--map file.map] [--algo astar8|astar|bfs|dfs] [--out per_scenario.csv]
+    mazefinder serve    [--load a.txt,b.txt] [--mazes K --size N --seed S] [--port P] [--bind ADDR] [--threads T] [--cache-mb M]
+    mazefinder client   [--host ADDR] [--port P] [--maze ID] [--algo NAME] [--queries q.txt | --count N]
+                        [--batch B] [--pipeline D] [--out replies.csv]
+    mazefinder publish  --name NAME [--size N | --load maze.txt] [--seed S] [--edit-ms MS]
+    mazefinder help
+
+    A command given an option it doesn't read prints this usage and exits 2, so a typo can't silently fall back to defaults.
+*/
+
+// "--key value" options and bare "--flag"s after the command name
+class CliArgs
+{
+private:
+    std::map<std::string, std::string> options;
+
+public:
+    bool parse(int argc, char * argv[], int first, std::string& error);
+
+    bool has(const std::string& key) const;
+    std::string getString(const std::string& key, const std::string& fallback) const;
+    unsigned int getUnsigned(const std::string& key, unsigned int fallback) const;
+    double getDouble(const std::string& key, double fallback) const;
+    bool allKnown(const std::vector<std::string>& known, std::string& error) const; // False names the first option not in known
+};
+
+// Either --load a maze file or generate one from --size / --seed
+bool loadOrGenerateMaze(const CliArgs& args, Maze& maze, std::string& error);
+
+// Reads "startRow startCol endRow endCol" lines.  Blank lines and '#' comments are skipped
+bool loadQueries(const std::string& fname, const Maze& maze, std::vector<Query>& queries, std::string& error);
+void randomQueries(const Maze& maze, unsigned int count, unsigned int seed, std::vector<Query>& queries);
+
+// Entry point from main() when there are any arguments.  Returns the process exit code
+int runCli(int argc, char * argv[]);
+
+#endif // !CLI_H
@@ -0,0 +1,412 @@
+#include "component_labels.h"
+
+#include <algorithm>
+
+const unsigned int ComponentLabels::NO_COMPONENT;
+const unsigned int ComponentLabels::MIN_STRIP_ROWS;
+
+ComponentLabels::ComponentLabels()
+    : rows(0), cols(0), components(0), editsReady(false), searchEpoch(0)
+{
+}
+
+unsigned int ComponentLabels::find(unsigned int cell)
+{
+    while (parent[cell] != cell)
+    {
+        parent[cell] = parent[parent[cell]];
+        cell = parent[cell];
+    }
+    return cell;
+}
+
+unsigned int ComponentLabels::findRoot(unsigned int cell) const
+{
+    while (parent[cell] != cell)
+        cell = parent[cell];
+    return cell;
+}
+
+void ComponentLabels::unite(unsigned int cellOne, unsigned int cellTwo)
+{
+    unsigned int rootOne = find(cellOne);
+    unsigned int rootTwo = find(cellTwo);
+
+    // The smaller root wins, that keeps every parent at or before its child
+    if (rootOne < rootTwo)
+        parent[rootTwo] = rootOne;
+    else if (rootTwo < rootOne)
+        parent[rootOne] = rootTwo;
+}
+
+template <class Grid>
+void ComponentLabels::uniteRows(const Grid & grid, unsigned int firstRow, unsigned int lastRow)
+{
+    for (unsigned int row = firstRow; row < lastRow; ++row)
+    {
+        unsigned int rowStart = row * cols;
+        for (unsigned int col = 0; col < cols; ++col)
+        {
+            unsigned int cell = rowStart + col;
+            if (!grid.isPath(cell))
+                continue;
+            if (col > 0 && grid.isPath(cell - 1))
+                unite(cell, cell - 1);
+            if (row > firstRow && grid.isPath(cell - cols))
+                unite(cell, cell - cols);
+        }
+    }
+}
+
+template <class Grid>
+void ComponentLabels::flattenRows(const Grid & grid, unsigned int firstRow, unsigned int lastRow, unsigned int & roots)
+{
+    // Parents come before children, so a parent inside these rows already has its label
+    unsigned int first = firstRow * cols;
+    unsigned int last = lastRow * cols;
+    roots = 0;
+    for (unsigned int cell = first; cell < last; ++cell)
+    {
+        if (!grid.isPath(cell)) {
+            labels[cell] = NO_COMPONENT;
+        }
+        else if (parent[cell] == cell) {
+            labels[cell] = cell;
+            ++roots;
+        }
+        else {
+            labels[cell] = parent[cell] >= first ? labels[parent[cell]] : findRoot(parent[cell]);
+        }
+    }
+}
+
+template <class Grid>
+void ComponentLabels::buildFrom(const Grid & grid, ThreadPool * pool)
+{
+    rows = grid.getRows();
+    cols = grid.getCols();
+    editsReady = false;
+    parent.resize(cellCount());
+    labels.resize(cellCount());
+    for (unsigned int cell = 0; cell < cellCount(); ++cell)
+        parent[cell] = cell;
+
+    unsigned int strips = 1;
+    if (pool && pool->size() > 1)
+        strips = std::max(1u, std::min(pool->size() * 4, rows / MIN_STRIP_ROWS));
+    if (strips == 1) {
+        uniteRows(grid, 0, rows);
+        flattenRows(grid, 0, rows, components);
+        return;
+    }
+
+    std::vector<unsigned int> firstRows;
+    for (unsigned int strip = 0; strip <= strips; ++strip)
+        firstRows.push_back(static_cast<unsigned int>(static_cast<unsigned long long>(rows) * strip / strips));
+
+    for (unsigned int strip = 0; strip < strips; ++strip)
+    {
+        pool->enqueue([this, &grid, &firstRows, strip](unsigned int) {
+            uniteRows(grid, firstRows[strip], firstRows[strip + 1]);
+        });
+    }
+    pool->wait();
+
+    // Join each strip to the one above it
+    for (unsigned int strip = 1; strip < strips; ++strip)
+    {
+        unsigned int rowStart = firstRows[strip] * cols;
+        for (unsigned int col = 0; col < cols; ++col)
+        {
+            unsigned int cell = rowStart + col;
+            if (grid.isPath(cell) && grid.isPath(cell - cols))
+                unite(cell, cell - cols);
+        }
+    }
+
+    std::vector<unsigned int> roots(strips, 0);
+    for (unsigned int strip = 0; strip < strips; ++strip)
+    {
+        pool->enqueue([this, &grid, &firstRows, &roots, strip](unsigned int) {
+            flattenRows(grid, firstRows[strip], firstRows[strip + 1], roots[strip]);
+        });
+    }
+    pool->wait();
+
+    components = 0;
+    for (unsigned int count : roots)
+        components += count;
+}
+
+void ComponentLabels::prepareEdits()
+{
+    if (editsReady)
+        return;
+    editsReady = true;
+    sizes.assign(cellCount(), 0);
+    for (unsigned int cell = 0; cell < cellCount(); ++cell)
+    {
+        if (labels[cell] != NO_COMPONENT)
+            ++sizes[labels[cell]];
+    }
+
+    // Every cell count is enough labels, there can't be more components than cells
+    freeLabels.clear();
+    for (unsigned int label = cellCount(); label-- > 0;)
+    {
+        if (sizes[label] == 0)
+            freeLabels.push_back(label);
+    }
+    if (searchMark.size() != cellCount()) {
+        searchMark.assign(cellCount(), 0);
+        searchEpoch = 0;
+    }
+}
+
+unsigned int ComponentLabels::takeLabel()
+{
+    unsigned int label = freeLabels.back();
+    freeLabels.pop_back();
+    return label;
+}
+
+template <class Grid>
+unsigned int ComponentLabels::pathNeighbors(const Grid & grid, unsigned int cell, unsigned int neighbors[4]) const
+{
+    unsigned int row = cell / cols;
+    unsigned int col = cell % cols;
+    unsigned int count = 0;
+    if (row > 0 && grid.isPath(cell - cols))
+        neighbors[count++] = cell - cols;
+    if (col > 0 && grid.isPath(cell - 1))
+        neighbors[count++] = cell - 1;
+    if (col + 1 < cols && grid.isPath(cell + 1))
+        neighbors[count++] = cell + 1;
+    if (row + 1 < rows && grid.isPath(cell + cols))
+        neighbors[count++] = cell + cols;
+    return count;
+}
+
+template <class Grid>
+void ComponentLabels::relabel(const Grid & grid, unsigned int from, unsigned int newLabel)
+{
+    // A cell is done once it has the new label, so no visited marks
+    unsigned int oldLabel = labels[from];
+    labels[from] = newLabel;
+    floodStack.clear();
+    floodStack.push_back(from);
+    while (!floodStack.empty())
+    {
+        unsigned int cell = floodStack.back();
+        floodStack.pop_back();
+        unsigned int neighbors[4];
+        unsigned int count = pathNeighbors(grid, cell, neighbors);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (labels[neighbors[i]] == oldLabel) {
+                labels[neighbors[i]] = newLabel;
+                floodStack.push_back(neighbors[i]);
+            }
+        }
+    }
+}
+
+template <class Grid>
+void ComponentLabels::openCellIn(const Grid & grid, unsigned int cell)
+{
+    if (cell >= cellCount() || labels[cell] != NO_COMPONENT || !grid.isPath(cell))
+        return;
+    prepareEdits();
+
+    unsigned int neighbors[4];
+    unsigned int count = pathNeighbors(grid, cell, neighbors);
+    if (count == 0) {
+        unsigned int label = takeLabel();
+        labels[cell] = label;
+        sizes[label] = 1;
+        ++components;
+        return;
+    }
+
+    // The biggest neighbor component keeps its label, the others are relabelled into it
+    unsigned int keep = labels[neighbors[0]];
+    for (unsigned int i = 1; i < count; ++i)
+    {
+        if (sizes[labels[neighbors[i]]] > sizes[keep])
+            keep = labels[neighbors[i]];
+    }
+    labels[cell] = keep;
+    ++sizes[keep];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int label = labels[neighbors[i]];
+        if (label == keep)
+            continue; // Already, or relabelled through an earlier neighbor
+        sizes[keep] += sizes[label];
+        sizes[label] = 0;
+        freeLabels.push_back(label);
+        --components;
+        relabel(grid, neighbors[i], keep);
+    }
+}
+
+template <class Grid>
+void ComponentLabels::closeCellIn(const Grid & grid, unsigned int cell)
+{
+    if (cell >= cellCount() || labels[cell] == NO_COMPONENT || grid.isPath(cell))
+        return;
+    prepareEdits();
+
+    unsigned int label = labels[cell];
+    labels[cell] = NO_COMPONENT;
+    --sizes[label];
+
+    unsigned int neighbors[4];
+    unsigned int count = pathNeighbors(grid, cell, neighbors);
+    if (count == 0) {
+        freeLabels.push_back(label);
+        --components;
+        return;
+    }
+    if (count == 1)
+        return; // The one neighbor still reaches everything it did
+
+    if (searchEpoch > UINT_MAX - 8) {
+        std::fill(searchMark.begin(), searchMark.end(), 0);
+        searchEpoch = 0;
+    }
+    searchEpoch += 4;
+
+    // group[] joins searches that met, they are exploring the same piece
+    unsigned int group[4];
+    size_t heads[4];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        group[i] = i;
+        heads[i] = 0;
+        searchCells[i].clear();
+        searchCells[i].push_back(neighbors[i]);
+        searchMark[neighbors[i]] = searchEpoch + i;
+    }
+    auto groupOf = [&group](unsigned int search) {
+        while (group[search] != search)
+            search = group[search];
+        return search;
+    };
+    auto groupDone = [&](unsigned int root) {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (groupOf(i) == root && heads[i] < searchCells[i].size())
+                return false;
+        }
+        return true;
+    };
+
+    unsigned int running = 0;
+    while (true)
+    {
+        unsigned int groups = 0;
+        running = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (groupOf(i) != i)
+                continue;
+            ++groups;
+            if (!groupDone(i))
+                ++running;
+        }
+        if (groups == 1)
+            return; // Everyone met, nothing split
+        if (running <= 1)
+            break;
+
+        // One cell per search per round, so no search gets far ahead of the smallest piece
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (heads[i] == searchCells[i].size())
+                continue;
+            unsigned int current = searchCells[i][heads[i]++];
+            unsigned int next[4];
+            unsigned int nextCount = pathNeighbors(grid, current, next);
+            for (unsigned int j = 0; j < nextCount; ++j)
+            {
+                unsigned int mark = searchMark[next[j]];
+                if (mark >= searchEpoch && mark < searchEpoch + 4) {
+                    unsigned int one = groupOf(i);
+                    unsigned int two = groupOf(mark - searchEpoch);
+                    if (one != two)
+                        group[std::max(one, two)] = std::min(one, two);
+                    continue;
+                }
+                searchMark[next[j]] = searchEpoch + i;
+                searchCells[i].push_back(next[j]);
+            }
+        }
+    }
+
+    // Groups that ran out are split off pieces.  If every group did, the first one keeps the old label
+    bool keepOne = running == 0;
+    for (unsigned int root = 0; root < count; ++root)
+    {
+        if (groupOf(root) != root || !groupDone(root))
+            continue;
+        if (keepOne) {
+            keepOne = false;
+            continue;
+        }
+
+        unsigned int newLabel = takeLabel();
+        unsigned int pieceSize = 0;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (groupOf(i) != root)
+                continue;
+            for (unsigned int piece : searchCells[i])
+                labels[piece] = newLabel;
+            pieceSize += static_cast<unsigned int>(searchCells[i].size());
+        }
+        sizes[newLabel] = pieceSize;
+        sizes[label] -= pieceSize;
+        ++components;
+    }
+}
+
+void ComponentLabels::openCell(const Maze & maze, unsigned int cell)
+{
+    openCellIn(maze, cell);
+}
+
+void ComponentLabels::openCell(const BitGrid & grid, unsigned int cell)
+{
+    openCellIn(grid, cell);
+}
+
+void ComponentLabels::closeCell(const Maze & maze, unsigned int cell)
+{
+    closeCellIn(maze, cell);
+}
+
+void ComponentLabels::closeCell(const BitGrid & grid, unsigned int cell)
+{
+    closeCellIn(grid, cell);
+}
+
+void ComponentLabels::build(const Maze & maze)
+{
+    buildFrom(maze, nullptr);
+}
+
+void ComponentLabels::build(const Maze & maze, ThreadPool & pool)
+{
+    buildFrom(maze, &pool);
+}
+
+void ComponentLabels::build(const BitGrid & grid)
+{
+    buildFrom(grid, nullptr);
+}
+
+void ComponentLabels::build(const BitGrid & grid, ThreadPool & pool)
+{
+    buildFrom(grid, &pool);
+}
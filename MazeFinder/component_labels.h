@@ -0,0 +1,97 @@
+#ifndef COMPONENT_LABELS_H
+#define COMPONENT_LABELS_H
+
+#include <vector>
+#include <climits>
+
+#include "maze.h"
+#include "bit_grid.h"
+#include "thread_pool.h"
+
+/*
+    Connected component label of every cell, so "is there a path at all" is two array reads.
+    Built with union-find over the right and down moves: a cell's parent is never above it, roots are the smallest
+    cell of their component, and the final labels fall out of one forward pass.  So a label is the component's
+    smallest cell, the same as ParallelDFS::labelRegions().
+
+    The pool version gives each task a strip of rows, unions inside the strips run side by side
+    (they only touch their own cells), then the rows between strips are joined on the calling thread.
+    Labels are the same either way.
+
+    Single cell edits are followed without a rebuild.  openCell() joins the new cell to its neighbors' components,
+    relabelling the smaller ones.  closeCell() only has to look further when the cell had 2+ path neighbors:
+    a search from each of them runs in lock step and stops as soon as all but one have met up or run out,
+    and the ones that ran out are the pieces that split off.  So the cost is the size of the smaller pieces,
+    in open areas the searches meet within a few steps.  Edited labels are only unique, not the smallest cell.
+*/
+class ComponentLabels
+{
+private:
+    unsigned int rows;
+    unsigned int cols;
+    unsigned int components;
+    std::vector<unsigned int> parent; // Union-find forest, parent[cell] <= cell
+    std::vector<unsigned int> labels;
+
+    unsigned int find(unsigned int cell); // Path halving
+    unsigned int findRoot(unsigned int cell) const; // No writes, for the parallel flatten
+    void unite(unsigned int cellOne, unsigned int cellTwo);
+
+    template <class Grid>
+    void uniteRows(const Grid& grid, unsigned int firstRow, unsigned int lastRow); // Up moves only from row firstRow + 1
+    template <class Grid>
+    void flattenRows(const Grid& grid, unsigned int firstRow, unsigned int lastRow, unsigned int& roots);
+    template <class Grid>
+    void buildFrom(const Grid& grid, ThreadPool * pool);
+
+    // Edit state, set up by the first edit after a build
+    bool editsReady;
+    std::vector<unsigned int> sizes; // Cells per label
+    std::vector<unsigned int> freeLabels; // Labels no component has
+    std::vector<unsigned int> floodStack;
+    std::vector<unsigned int> searchMark; // searchEpoch + search index of the cells each split check search reached
+    unsigned int searchEpoch;
+    std::vector<unsigned int> searchCells[4]; // Cells reached, in order.  Also each search's queue
+    void prepareEdits();
+    unsigned int takeLabel();
+
+    template <class Grid>
+    unsigned int pathNeighbors(const Grid& grid, unsigned int cell, unsigned int neighbors[4]) const;
+    template <class Grid>
+    void relabel(const Grid& grid, unsigned int from, unsigned int newLabel); // from's whole component
+    template <class Grid>
+    void openCellIn(const Grid& grid, unsigned int cell);
+    template <class Grid>
+    void closeCellIn(const Grid& grid, unsigned int cell);
+
+public:
+    static const unsigned int NO_COMPONENT = UINT_MAX;
+    static const unsigned int MIN_STRIP_ROWS = 64; // Fewer rows per task and the joins cost more than they save
+
+    //Constructor
+    ComponentLabels();
+
+    void build(const Maze& maze);
+    void build(const Maze& maze, ThreadPool& pool);
+    void build(const BitGrid& grid); // Graph keeps its walls in one
+    void build(const BitGrid& grid, ThreadPool& pool);
+
+    // grid has the edit already, cell just became path / wall.  Same grid size as the build, a repeated edit does nothing
+    void openCell(const Maze& maze, unsigned int cell);
+    void openCell(const BitGrid& grid, unsigned int cell);
+    void closeCell(const Maze& maze, unsigned int cell);
+    void closeCell(const BitGrid& grid, unsigned int cell);
+
+    unsigned int cellCount() const { return rows * cols; }
+    unsigned int count() const { return components; }
+    unsigned int label(unsigned int cell) const { return cell < labels.size() ? labels[cell] : NO_COMPONENT; }
+    const std::vector<unsigned int>& getLabels() const { return labels; }
+
+    // False when either cell is a wall or outside the grid
+    bool connected(unsigned int cellOne, unsigned int cellTwo) const
+    {
+        return label(cellOne) != NO_COMPONENT && label(cellOne) == label(cellTwo);
+    }
+};
+
+#endif // !COMPONENT_LABELS_H
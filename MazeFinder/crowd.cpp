@@ -0,0 +1,250 @@
+#include "crowd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+    std::uint32_t nextRandom(std::uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // 0..1
+    float randomUnit(std::uint32_t& state)
+    {
+        return (nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Never 0, xorshift would stay there
+    std::uint32_t agentSeed(std::uint32_t seed, unsigned int agent)
+    {
+        std::uint32_t mixed = seed * 2654435761u ^ (agent + 0x9e3779b9u) * 0x85ebca6bu;
+        mixed ^= mixed >> 16;
+        return mixed ? mixed : 1;
+    }
+
+    const float ON_THE_WAY = 1e-4f; // How far off the line to the next spot still counts as on it
+
+}  // namespace
+
+const unsigned int Crowd::CELL_CAPACITY;
+const unsigned int Crowd::AGENTS_PER_TASK;
+const unsigned int Crowd::PLACE_TRIES;
+const float Crowd::MIN_SPEED = 2.5f;
+const float Crowd::MAX_SPEED = 5.0f;
+const float Crowd::CROWDING_SLOWDOWN = 0.25f;
+
+Crowd::Crowd(std::uint32_t seed)
+    : bucketShift(31), rows(0), cols(0), seed(seed), arrivals(0)
+{
+}
+
+unsigned int Crowd::bucketOf(unsigned int cell) const
+{
+    return (cell * 2654435761u) >> bucketShift;
+}
+
+void Crowd::rebuildHash()
+{
+    unsigned int bits = 1;
+    while ((size_t(1) << bits) < 2 * cells.size() && bits < 31)
+        ++bits;
+    bucketShift = 32 - bits;
+    unsigned int buckets = 1u << bits;
+
+    bucketStarts.assign(buckets + 1, 0);
+    for (unsigned int cell : cells)
+        ++bucketStarts[bucketOf(cell) + 1];
+    for (unsigned int b = 0; b < buckets; ++b)
+        bucketStarts[b + 1] += bucketStarts[b];
+
+    bucketFill.assign(bucketStarts.begin(), bucketStarts.end() - 1);
+    bucketCells.resize(cells.size());
+    for (unsigned int cell : cells)
+        bucketCells[bucketFill[bucketOf(cell)]++] = cell;
+}
+
+unsigned int Crowd::occupancy(unsigned int cell) const
+{
+    if (bucketStarts.empty())
+        return 0;
+    unsigned int bucket = bucketOf(cell);
+    unsigned int count = 0;
+    for (unsigned int i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; ++i)
+    {
+        if (bucketCells[i] == cell)
+            ++count;
+    }
+    return count;
+}
+
+void Crowd::place(const FlowField & field, unsigned int agent)
+{
+    unsigned int cell = field.getGoal();
+    for (unsigned int tries = 0; tries < PLACE_TRIES; ++tries)
+    {
+        unsigned int pick = nextRandom(seeds[agent]) % field.cellCount();
+        unsigned int distance = field.distance(pick);
+        if (distance != FlowField::UNREACHED && distance != 0) {
+            cell = pick;
+            break;
+        }
+    }
+    cells[agent] = cell;
+    posX[agent] = cell % cols + 0.5f + offsetX[agent];
+    posY[agent] = cell / cols + 0.5f + offsetY[agent];
+}
+
+void Crowd::spawn(const FlowField & field, unsigned int count)
+{
+    clear();
+    if (!field.isBuilt() || field.getGoal() >= field.cellCount())
+        return;
+    rows = field.getRows();
+    cols = field.getCols();
+
+    posX.resize(count);
+    posY.resize(count);
+    cells.resize(count);
+    speeds.resize(count);
+    offsetX.resize(count);
+    offsetY.resize(count);
+    seeds.resize(count);
+    waiting.assign(count, 0);
+    for (unsigned int agent = 0; agent < count; ++agent)
+    {
+        seeds[agent] = agentSeed(seed, agent);
+        speeds[agent] = MIN_SPEED + (MAX_SPEED - MIN_SPEED) * randomUnit(seeds[agent]);
+        offsetX[agent] = (randomUnit(seeds[agent]) - 0.5f) * 0.6f;
+        offsetY[agent] = (randomUnit(seeds[agent]) - 0.5f) * 0.6f;
+        place(field, agent);
+    }
+    rebuildHash();
+}
+
+void Crowd::clear()
+{
+    posX.clear();
+    posY.clear();
+    cells.clear();
+    speeds.clear();
+    offsetX.clear();
+    offsetY.clear();
+    seeds.clear();
+    waiting.clear();
+    bucketStarts.clear();
+    bucketCells.clear();
+    arrivals = 0;
+}
+
+unsigned int Crowd::stepRange(const FlowField & field, float seconds, unsigned int first, unsigned int last)
+{
+    unsigned int arrived = 0;
+    for (unsigned int agent = first; agent < last; ++agent)
+    {
+        waiting[agent] = 0;
+        unsigned int cell = cells[agent];
+        unsigned int distance = field.distance(cell);
+        if (distance == 0) {
+            ++arrived;
+            place(field, agent);
+            continue;
+        }
+        if (distance == FlowField::UNREACHED) {
+            // A wall went up on it or around it
+            place(field, agent);
+            continue;
+        }
+
+        float x = posX[agent];
+        float y = posY[agent];
+        float budget = speeds[agent] * seconds;
+        unsigned int crowding = occupancy(cell);
+        if (crowding > 1)
+            budget /= 1.0f + CROWDING_SLOWDOWN * (crowding - 1);
+
+        // A few cells at most, a long frame shouldn't teleport anyone
+        for (unsigned int moves = 0; moves < 4 && budget > 0; ++moves)
+        {
+            unsigned int next = field.next(cell);
+            if (next == FlowField::NO_CELL)
+                break;
+            float spotX = cell % cols + 0.5f + offsetX[agent];
+            float spotY = cell / cols + 0.5f + offsetY[agent];
+            int stepCol = static_cast<int>(next % cols) - static_cast<int>(cell % cols);
+            int stepRow = static_cast<int>(next / cols) - static_cast<int>(cell / cols);
+
+            // Part way to a spot the field no longer points at, back to our own spot first so no corner gets cut
+            float awayX = x - spotX;
+            float awayY = y - spotY;
+            bool onTheWay = stepCol != 0 ? std::fabs(awayY) < ON_THE_WAY && awayX * stepCol >= 0
+                : std::fabs(awayX) < ON_THE_WAY && awayY * stepRow >= 0;
+            float targetX = spotX;
+            float targetY = spotY;
+            bool entering = false;
+            if (onTheWay) {
+                if (occupancy(next) >= CELL_CAPACITY) {
+                    waiting[agent] = 1;
+                    break;
+                }
+                targetX += stepCol;
+                targetY += stepRow;
+                entering = true;
+            }
+
+            float dx = targetX - x;
+            float dy = targetY - y;
+            float length = std::sqrt(dx * dx + dy * dy);
+            if (length > budget) {
+                x += dx * budget / length;
+                y += dy * budget / length;
+                break;
+            }
+            x = targetX;
+            y = targetY;
+            budget -= length;
+            if (entering) {
+                cell = next;
+                if (field.distance(cell) == 0)
+                    break;
+            }
+        }
+        posX[agent] = x;
+        posY[agent] = y;
+        cells[agent] = cell;
+    }
+    return arrived;
+}
+
+void Crowd::step(const FlowField & field, float seconds, ThreadPool * pool)
+{
+    if (cells.empty() || !field.isBuilt())
+        return;
+    if (field.getRows() != rows || field.getCols() != cols) {
+        spawn(field, static_cast<unsigned int>(cells.size()));
+        return;
+    }
+
+    unsigned int count = static_cast<unsigned int>(cells.size());
+    if (!pool || count <= AGENTS_PER_TASK) {
+        arrivals += stepRange(field, seconds, 0, count);
+    }
+    else {
+        std::atomic<unsigned long long> arrived(0);
+        for (unsigned int first = 0; first < count; first += AGENTS_PER_TASK)
+        {
+            unsigned int last = std::min(count, first + AGENTS_PER_TASK);
+            pool->enqueue([this, &field, seconds, first, last, &arrived](unsigned int) {
+                arrived += stepRange(field, seconds, first, last);
+            });
+        }
+        pool->wait();
+        arrivals += arrived;
+    }
+    rebuildHash();
+}
@@ -0,0 +1,80 @@
+#ifndef CROWD_H
+#define CROWD_H
+
+#include <vector>
+#include <cstdint>
+
+#include "flow_field.h"
+#include "thread_pool.h"
+
+/*
+    Thousands of agents walking down a FlowField to its goal.  Agents that get there, or end up somewhere the goal
+    can't be reached from any more, start over on a random reachable cell, so the crowd keeps flowing.
+
+    Agent state is one array per field, agent i is element i of every array.  step() hands AGENTS_PER_TASK agents
+    to each pool task.  An agent only writes its own elements, and only reads the spatial hash built at the end of
+    the last step, so results don't depend on the thread count.
+
+    An agent walks between its own spot in each cell (the cell center plus a fixed offset, so a full cell doesn't
+    stack everyone on one point) and only changes cell once it gets there.  Before it heads into the next cell
+    it checks the hash: CELL_CAPACITY agents already in there and it waits, and every agent in its own cell
+    beyond itself slows it down a little.
+
+    The spatial hash is agent cells counting sorted into a power of two table, twice the agent count.
+    It scales with the crowd, not with the map.
+*/
+class Crowd
+{
+private:
+    // Structure of arrays
+    std::vector<float> posX; // Column, in cells.  Cell centers are at .5
+    std::vector<float> posY; // Row
+    std::vector<unsigned int> cells; // Cell the agent stands in, it leaves it when it reaches the next spot
+    std::vector<float> speeds; // Cells per second
+    std::vector<float> offsetX; // Own spot inside any cell, from the center
+    std::vector<float> offsetY;
+    std::vector<std::uint32_t> seeds; // Per agent xorshift state for respawns
+    std::vector<unsigned char> waiting; // Held back by a full cell this step
+
+    // Spatial hash, rebuilt after every step
+    unsigned int bucketShift; // Fibonacci hashing, the table has 1 << (32 - bucketShift) buckets
+    std::vector<unsigned int> bucketStarts; // Bucket b is bucketCells[bucketStarts[b] .. bucketStarts[b + 1])
+    std::vector<unsigned int> bucketCells;
+    std::vector<unsigned int> bucketFill; // rebuildHash scratch
+
+    unsigned int rows;
+    unsigned int cols;
+    std::uint32_t seed;
+    unsigned long long arrivals;
+
+    unsigned int bucketOf(unsigned int cell) const;
+    void rebuildHash();
+    void place(const FlowField& field, unsigned int agent); // Random reachable cell, or the goal when there's none
+    unsigned int stepRange(const FlowField& field, float seconds, unsigned int first, unsigned int last); // Returns arrivals
+
+public:
+    static const unsigned int CELL_CAPACITY = 4; // Agents in a cell before the ones behind wait
+    static const unsigned int AGENTS_PER_TASK = 2048;
+    static const unsigned int PLACE_TRIES = 64; // Random picks per spawn before giving up and using the goal
+    static const float MIN_SPEED; // Cells per second
+    static const float MAX_SPEED;
+    static const float CROWDING_SLOWDOWN; // Speed lost per extra agent in the same cell
+
+    //Constructor
+    explicit Crowd(std::uint32_t seed = 1);
+
+    void spawn(const FlowField& field, unsigned int count); // Replaces every agent
+    void clear();
+    void step(const FlowField& field, float seconds, ThreadPool * pool = nullptr);
+
+    size_t size() const { return cells.size(); }
+    const std::vector<float>& getX() const { return posX; }
+    const std::vector<float>& getY() const { return posY; }
+    const std::vector<unsigned char>& getWaiting() const { return waiting; }
+    unsigned int getCell(unsigned int agent) const { return cells[agent]; }
+    unsigned long long getArrivals() const { return arrivals; }
+
+    unsigned int occupancy(unsigned int cell) const; // Agents in cell as of the last step
+};
+
+#endif // !CROWD_H
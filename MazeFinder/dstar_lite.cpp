@@ -0,0 +1,219 @@
+#include "dstar_lite.h"
+
+const unsigned int DStarLite::UNREACHED;
+const unsigned int DStarLite::STALE_FACTOR;
+
+namespace {
+
+    bool keyLess(const HeapNode& a, const HeapNode& b)
+    {
+        if (a.f_cost != b.f_cost)
+            return a.f_cost < b.f_cost;
+        return a.h_cost < b.h_cost;
+    }
+
+}  // namespace
+
+DStarLite::DStarLite()
+    : rows(0), cols(0), start(0), end(0), lastStart(0), km(0), expanded(0)
+{
+}
+
+unsigned int DStarLite::heuristic(unsigned int from, unsigned int to) const
+{
+    unsigned int fromRow = from / cols, fromCol = from % cols;
+    unsigned int toRow = to / cols, toCol = to % cols;
+    return (fromRow > toRow ? fromRow - toRow : toRow - fromRow) + (fromCol > toCol ? fromCol - toCol : toCol - fromCol);
+}
+
+HeapNode DStarLite::keyOf(unsigned int cell) const
+{
+    unsigned int best = g[cell] < rhs[cell] ? g[cell] : rhs[cell];
+    if (best == UNREACHED)
+        return { UNREACHED, UNREACHED, cell }; // Would wrap around to a tiny key
+    return { best + heuristic(start, cell) + km, best, cell };
+}
+
+unsigned int DStarLite::neighbors(unsigned int cell, unsigned int out[4]) const
+{
+    unsigned int row = cell / cols;
+    unsigned int col = cell % cols;
+    unsigned int count = 0;
+    if (row > 0 && !walls[cell - cols])
+        out[count++] = cell - cols;
+    if (col > 0 && !walls[cell - 1])
+        out[count++] = cell - 1;
+    if (row + 1 < rows && !walls[cell + cols])
+        out[count++] = cell + cols;
+    if (col + 1 < cols && !walls[cell + 1])
+        out[count++] = cell + 1;
+    return count;
+}
+
+unsigned int DStarLite::lookahead(unsigned int cell) const
+{
+    unsigned int next[4];
+    unsigned int count = neighbors(cell, next);
+    unsigned int best = UNREACHED;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (g[next[i]] != UNREACHED && g[next[i]] + 1 < best)
+            best = g[next[i]] + 1;
+    }
+    return best;
+}
+
+void DStarLite::updateCell(unsigned int cell)
+{
+    if (cell != end)
+        rhs[cell] = walls[cell] ? UNREACHED : lookahead(cell);
+
+    // Whatever entry it already has is left in, the pop sorts out which one is current
+    if (g[cell] != rhs[cell])
+        open.heapInsert(keyOf(cell));
+}
+
+void DStarLite::computeShortestPath()
+{
+    while (!open.empty())
+    {
+        if (open.size() > static_cast<size_t>(STALE_FACTOR) * cellCount())
+            compact();
+
+        HeapNode top;
+        open.heapExtractMin(top);
+        if (!keyLess(top, keyOf(start)) && rhs[start] <= g[start]) {
+            open.heapInsert(top); // Start is settled, nothing left below it matters
+            return;
+        }
+
+        unsigned int cell = top.cell;
+        if (g[cell] == rhs[cell])
+            continue; // Stale
+        HeapNode current = keyOf(cell);
+        if (keyLess(top, current)) {
+            open.heapInsert(current); // Key went up since it was queued (km or a changed g)
+            continue;
+        }
+
+        ++expanded;
+        unsigned int next[4];
+        unsigned int count = neighbors(cell, next);
+        if (g[cell] > rhs[cell]) {
+            g[cell] = rhs[cell]; // Got shorter, settle it
+        }
+        else {
+            g[cell] = UNREACHED; // Got longer, let it find its new distance through the open list
+            updateCell(cell);
+        }
+        for (unsigned int i = 0; i < count; ++i)
+            updateCell(next[i]);
+    }
+}
+
+void DStarLite::compact()
+{
+    open.clear();
+    for (unsigned int cell = 0; cell < cellCount(); ++cell)
+    {
+        if (g[cell] != rhs[cell])
+            open.heapInsert(keyOf(cell));
+    }
+}
+
+void DStarLite::beginCells(unsigned int rows, unsigned int cols, unsigned int start, unsigned int end)
+{
+    this->rows = rows;
+    this->cols = cols;
+    this->start = start;
+    this->end = end;
+    lastStart = start;
+    km = 0;
+    g.assign(cellCount(), UNREACHED);
+    rhs.assign(cellCount(), UNREACHED);
+    open.clear();
+    if (end < cellCount()) {
+        rhs[end] = 0;
+        open.heapInsert(keyOf(end));
+    }
+}
+
+void DStarLite::begin(const Maze & maze, unsigned int start, unsigned int end)
+{
+    walls.assign(maze.data(), maze.data() + maze.cellCount());
+    beginCells(maze.getRows(), maze.getCols(), start, end);
+}
+
+void DStarLite::begin(const BitGrid & grid, unsigned int start, unsigned int end)
+{
+    walls.resize(grid.cellCount());
+    for (unsigned int cell = 0; cell < grid.cellCount(); ++cell)
+        walls[cell] = grid.isPath(cell) ? 0 : 1;
+    beginCells(grid.getRows(), grid.getCols(), start, end);
+}
+
+void DStarLite::setWall(unsigned int cell, bool wall)
+{
+    if (cell >= cellCount() || (walls[cell] != 0) == wall)
+        return;
+    walls[cell] = wall ? 1 : 0;
+
+    // Every edge into or out of cell changed cost.  The neighbors see it through their lookahead
+    unsigned int row = cell / cols;
+    unsigned int col = cell % cols;
+    updateCell(cell);
+    if (row > 0)
+        updateCell(cell - cols);
+    if (col > 0)
+        updateCell(cell - 1);
+    if (row + 1 < rows)
+        updateCell(cell + cols);
+    if (col + 1 < cols)
+        updateCell(cell + 1);
+}
+
+void DStarLite::moveStart(unsigned int start)
+{
+    if (start >= cellCount())
+        return;
+
+    // Keys already queued were made with the old start.  Raising km keeps them lower bounds
+    this->start = start;
+    km += heuristic(lastStart, start);
+    lastStart = start;
+}
+
+SolveResult DStarLite::solve(std::vector<unsigned int>* path)
+{
+    expanded = 0;
+    if (start >= cellCount() || end >= cellCount() || walls[start] || walls[end])
+        return { false, 0, 0 };
+
+    computeShortestPath();
+    unsigned int length = start == end ? 0 : rhs[start];
+    if (length == UNREACHED)
+        return { false, 0, expanded };
+
+    // Downhill on g.  Cells on a shortest path are keyed below start, so they are all settled
+    if (path) {
+        path->clear();
+        path->push_back(start);
+        unsigned int cell = start;
+        while (cell != end && path->size() <= length)
+        {
+            unsigned int next[4];
+            unsigned int count = neighbors(cell, next);
+            unsigned int best = UNREACHED;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                if (best == UNREACHED || g[next[i]] < g[best])
+                    best = next[i];
+            }
+            if (best == UNREACHED || g[best] == UNREACHED)
+                break;
+            cell = best;
+            path->push_back(cell);
+        }
+    }
+    return { true, length, expanded };
+}
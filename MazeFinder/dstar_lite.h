@@ -0,0 +1,73 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <vector>
+#include <climits>
+
+#include "maze.h"
+#include "bit_grid.h"
+#include "solver.h"
+
+/*
+    D* Lite (Koenig & Likhachev): A* that keeps its search between wall edits and only repairs what an edit touched.
+    It searches backwards, g is the distance to end, so moving the start along the path doesn't throw anything away.
+    rhs is the one step lookahead, min over neighbors of g + 1.  A cell with g != rhs is inconsistent and sits on
+    the open list, keyed by [min(g, rhs) + h(start) + km, min(g, rhs)].  km grows by h(old start, new start) when
+    the start moves, so old keys stay valid lower bounds.
+
+    The planner keeps its own copy of the walls, taken by begin().  Report edits with setWall(), the next solve()
+    only expands cells whose distance changed.  Small edits near the path cost a handful of expansions
+    where solveAStar() would start over.
+
+    The open list is a MinHeap with stale entries left in: a popped cell that is consistent, or whose key went up,
+    is skipped or pushed again.  compact() rebuilds it when the stale entries pile up.
+*/
+class DStarLite
+{
+private:
+    unsigned int rows;
+    unsigned int cols;
+    unsigned int start;
+    unsigned int end;
+    unsigned int lastStart; // Start when km was last brought up to date
+    unsigned int km;
+    std::vector<unsigned char> walls; // 1 = wall, same as Maze
+    std::vector<unsigned int> g; // Distance to end
+    std::vector<unsigned int> rhs;
+    MinHeap open; // f_cost / h_cost are the two halves of the key
+    unsigned int expanded; // Since the last solve()
+
+    unsigned int heuristic(unsigned int from, unsigned int to) const; // Manhattan
+    HeapNode keyOf(unsigned int cell) const;
+    unsigned int neighbors(unsigned int cell, unsigned int out[4]) const; // Open neighbors
+    unsigned int lookahead(unsigned int cell) const; // min over open neighbors of g + 1
+    void updateCell(unsigned int cell);
+    void computeShortestPath();
+    void compact(); // Heap back to one entry per inconsistent cell
+    void beginCells(unsigned int rows, unsigned int cols, unsigned int start, unsigned int end);
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+    static const unsigned int STALE_FACTOR = 4; // compact() once the heap holds this many entries per cell
+
+    //Constructor
+    DStarLite();
+
+    // Fresh plan.  Walls are copied, nothing is searched until solve()
+    void begin(const Maze& maze, unsigned int start, unsigned int end);
+    void begin(const BitGrid& grid, unsigned int start, unsigned int end);
+
+    void setWall(unsigned int cell, bool wall); // No-op when it already is
+    void moveStart(unsigned int start);
+
+    // Same answer as solveAStar(): found, shortest pathLength, and the path when asked.
+    // expanded only counts the cells this call had to repair
+    SolveResult solve(std::vector<unsigned int> * path = nullptr);
+
+    bool isWall(unsigned int cell) const { return walls[cell] != 0; }
+    unsigned int getStart() const { return start; }
+    unsigned int getEnd() const { return end; }
+    unsigned int cellCount() const { return rows * cols; }
+};
+
+#endif // !DSTAR_LITE_H
@@ -0,0 +1,87 @@
+#include "flow_field.h"
+
+const unsigned int FlowField::UNREACHED;
+const unsigned int FlowField::NO_CELL;
+const unsigned char FlowField::UP;
+const unsigned char FlowField::LEFT;
+const unsigned char FlowField::DOWN;
+const unsigned char FlowField::RIGHT;
+
+FlowField::FlowField()
+    : rows(0), cols(0), goal(NO_CELL)
+{
+}
+
+void FlowField::buildMoves()
+{
+    // Any neighbor one closer works, the BFS put it there through a path cell
+    moves.assign((cellCount() + 3) / 4, 0);
+    for (unsigned int cell = 0; cell < cellCount(); ++cell)
+    {
+        unsigned int here = distances[cell];
+        if (here == UNREACHED || here == 0)
+            continue;
+        unsigned int row = cell / cols;
+        unsigned int col = cell % cols;
+        if (row > 0 && distances[cell - cols] == here - 1)
+            setMove(cell, UP);
+        else if (col > 0 && distances[cell - 1] == here - 1)
+            setMove(cell, LEFT);
+        else if (row + 1 < rows && distances[cell + cols] == here - 1)
+            setMove(cell, DOWN);
+        else
+            setMove(cell, RIGHT);
+    }
+}
+
+void FlowField::build(const BitGrid & grid, unsigned int goal)
+{
+    rows = grid.getRows();
+    cols = grid.getCols();
+    this->goal = goal;
+    if (goal >= cellCount() || !grid.isPath(goal))
+        distances.assign(cellCount(), UNREACHED);
+    else
+        grid.layerDistances(scratch, goal, distances);
+    buildMoves();
+}
+
+void FlowField::build(const Maze & maze, unsigned int goal, ParallelBFS & bfs)
+{
+    rows = maze.getRows();
+    cols = maze.getCols();
+    this->goal = goal;
+    if (goal >= cellCount() || maze.isWall(goal))
+        distances.assign(cellCount(), UNREACHED);
+    else
+        bfs.distances(maze, goal, distances);
+    buildMoves();
+}
+
+unsigned int FlowField::next(unsigned int cell) const
+{
+    if (cell >= cellCount() || distances[cell] == UNREACHED || distances[cell] == 0)
+        return NO_CELL;
+    switch (move(cell))
+    {
+    case UP:
+        return cell - cols;
+    case LEFT:
+        return cell - 1;
+    case DOWN:
+        return cell + cols;
+    default:
+        return cell + 1;
+    }
+}
+
+bool FlowField::path(unsigned int cell, std::vector<unsigned int>& cells) const
+{
+    cells.clear();
+    if (distance(cell) == UNREACHED)
+        return false;
+    cells.reserve(distances[cell] + 1);
+    for (; cell != NO_CELL; cell = next(cell))
+        cells.push_back(cell);
+    return true;
+}
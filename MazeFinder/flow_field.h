@@ -0,0 +1,65 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <vector>
+#include <climits>
+
+#include "maze.h"
+#include "bit_grid.h"
+#include "parallel_bfs.h"
+
+/*
+    Distance to one goal from every cell, plus the move that gets each cell one step closer.
+    One reverse BFS from the goal answers every "how far / which way" question for any number of agents,
+    a path is read off one move at a time, no search.
+
+    Moves are 2 bits per cell (four cells to a byte), only meaningful where distance is finite and not 0.
+    Ties go up, left, down, right, in that order.
+*/
+class FlowField
+{
+private:
+    unsigned int rows;
+    unsigned int cols;
+    unsigned int goal;
+    std::vector<unsigned int> distances;
+    std::vector<unsigned char> moves; // 2 bits per cell
+    BitScratch scratch;
+
+    void buildMoves(); // From distances
+    void setMove(unsigned int cell, unsigned char move) { moves[cell / 4] |= static_cast<unsigned char>(move << (2 * (cell % 4))); }
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+    static const unsigned int NO_CELL = UINT_MAX;
+
+    // Values of move()
+    static const unsigned char UP = 0;
+    static const unsigned char LEFT = 1;
+    static const unsigned char DOWN = 2;
+    static const unsigned char RIGHT = 3;
+
+    //Constructor
+    FlowField();
+
+    // A goal on a wall or off the grid builds a field where every cell is UNREACHED, same as solveBFS finding no path
+    void build(const BitGrid& grid, unsigned int goal); // Word parallel BFS, Graph keeps its walls in one
+    void build(const Maze& maze, unsigned int goal, ParallelBFS& bfs); // Big mazes, the BFS runs on bfs's pool
+
+    bool isBuilt() const { return !distances.empty(); }
+    unsigned int getGoal() const { return goal; }
+    unsigned int getRows() const { return rows; }
+    unsigned int getCols() const { return cols; }
+    unsigned int cellCount() const { return rows * cols; }
+    unsigned int distance(unsigned int cell) const { return cell < distances.size() ? distances[cell] : UNREACHED; }
+    const std::vector<unsigned int>& getDistances() const { return distances; }
+    unsigned char move(unsigned int cell) const { return (moves[cell / 4] >> (2 * (cell % 4))) & 3; }
+
+    // Cell one move closer to the goal.  NO_CELL at the goal or where it can't be reached
+    unsigned int next(unsigned int cell) const;
+
+    // cell .. goal inclusive, false (path empty) when cell can't reach the goal
+    bool path(unsigned int cell, std::vector<unsigned int>& cells) const;
+};
+
+#endif // !FLOW_FIELD_H
@@ -5,17 +5,28 @@ void Graph::initGraph(float blockSize)
     debugOffset = 240.f; // Create an offset size for debug text at top of screen.  120.f was a while
     this->blockSize = blockSize;
     createLog(": Graph::initGraph()", MazeLog::FileLogger::e_logType::LOG_INFO);
-    pathVec.reserve(gridSize*gridSize);
+    resetScratch(false); // The first search sizes them, a Graph that never searches never pays for them
     mazeDivideCounter = 0;
+    frameCount = 0;
+    mazeHash = zobristBase(gridSize, gridSize);
+    walls.reset(gridSize, gridSize, true);
+    componentsDirty = true;
+    replanActive = false;
+    flowActive = false;
+    flowDirty = true;
+    crowdActive = false;
+    crowdStepMs = 0.f;
+    crowdVertices.setPrimitiveType(sf::Quads);
+    search.begin(gridSize * gridSize);
+    expandedCount = 0;
     endFound = false;
 }
 
 // Init Individual Blocks
-Vertex::Vertex(float xpos, float ypos, float blockSize)
+Vertex::Vertex()
 {
-    visited = false;
+    shape = nullptr;
     isPath = true;
-    pathDistance = 0;
     explosionHole = false;
     haveNeighbors = false;
 
@@ -23,36 +34,32 @@ Vertex::Vertex(float xpos, float ypos, float blockSize)
     left = nullptr;
     bottom = nullptr;
     right = nullptr;
-
-    // astar
-    aStarParent = nullptr;
-    g_cost = INT_MAX;
-    h_cost = INT_MAX;
-    f_cost = INT_MAX;
-
-    // shape
-    shape.setFillColor(sf::Color::Black);
-    shape.setOutlineThickness(1.f);
-    shape.setOutlineColor(sf::Color::White);
-    shape.setPosition(xpos, ypos);
-    shape.setSize(sf::Vector2f(blockSize, blockSize));
-
 }
 
-void Graph::initMatrix()
+void Graph::initMatrix(bool drawn)
 {
-    // Initialize the grid with vertexes
+    // Initialize the grid with vertexes.  One arena block for all of them instead of N^2 news
+    vertices = gridArena.allocateArray<Vertex>(gridSize * gridSize);
+    if (drawn)
+        shapes = gridArena.allocateArray<sf::RectangleShape>(gridSize * gridSize);
     grid.reserve(gridSize); 
     for (size_t i = 0; i < gridSize; i++)
     {
-        std::vector<Vertex*> temp;
-        temp.reserve(gridSize);
-        grid.emplace_back(temp);
+        grid.emplace_back(ArenaAllocator<Vertex*>(&gridArena));
+        grid[i].reserve(gridSize);
         for (size_t j = 0; j < gridSize; j++)
         {
-            grid[i].emplace_back(new Vertex( j * blockSize, (i * blockSize) + debugOffset, blockSize)); // x, y + offset, blocksize
+            grid[i].emplace_back(new (&vertices[i * gridSize + j]) Vertex());
             grid[i][j]->col = j;
             grid[i][j]->row = i;
+            if (shapes) {
+                sf::RectangleShape * shape = new (&shapes[i * gridSize + j]) sf::RectangleShape(sf::Vector2f(blockSize, blockSize));
+                shape->setFillColor(sf::Color::Black);
+                shape->setOutlineThickness(1.f);
+                shape->setOutlineColor(sf::Color::White);
+                shape->setPosition(j * blockSize, (i * blockSize) + debugOffset); // x, y + offset
+                grid[i][j]->shape = shape;
+            }
         }
     }
 
@@ -77,7 +84,7 @@ void Graph::initGui()
 
     // Hotkey Info Text
     debugTextHotKeyInfo.setFont(debugFont);
-    debugTextHotKeyInfo.setCharacterSize(20);
+    debugTextHotKeyInfo.setCharacterSize(16); // 20 no longer fits every hotkey above the grid
     debugTextHotKeyInfo.setFillColor(sf::Color::White);
     debugTextHotKeyInfo.setPosition((gridSize * blockSize) - 200.f, 10.f); // Anchor it from the right by -X
 
@@ -86,23 +93,35 @@ void Graph::initGui()
     debugPathDistance.setFillColor(sf::Color::White);
     debugPathDistance.setPosition(10.f, 120.f);
 
+    // Crowd agents.  715px scaled down to a fraction of a block, mipmaps keep it from shimmering
+    if (!agentTexture.loadFromFile("Textures/ball.png"))
+        std::cout << "ERROR: Ball texture failed to load!\n";
+    agentTexture.setSmooth(true);
+    agentTexture.generateMipmap();
+
     createLog(": Graph::initGui()", MazeLog::FileLogger::e_logType::LOG_INFO);
 }
 
 void Graph::initSound()
 {
     // Music
-    if (!this->music.openFromFile("Sounds/Blues.ogg"))
+    music.reset(new sf::Music);
+    if (!this->music->openFromFile("Sounds/Blues.ogg"))
         std::cout << "ERROR: Music did not load!\n";
 
-    music.setVolume(7);
-    music.play();
-    music.setLoop(true);
+    music->setVolume(7);
+    music->play();
+    music->setLoop(true);
 }
 
-void Graph::initLogger()
+void Graph::initLogger(const GraphOptions& options)
 {
-    logger.initFile();
+    logger = options.logger;
+    if (!logger && !options.logFile.empty()) {
+        ownedLogger.reset(new MazeLog::FileLogger);
+        ownedLogger->initFile(options.logFile);
+        logger = ownedLogger.get();
+    }
 }
 
 void Graph::initWindow()
@@ -115,35 +134,41 @@ void Graph::initWindow()
     createLog(": Graph::initWindow()", MazeLog::FileLogger::e_logType::LOG_INFO);
 }
 
-Graph::Graph(unsigned int size, float blockSize)
+Graph::Graph(unsigned int size, float blockSize, const GraphOptions& options)
+    : window(nullptr), vertices(nullptr), shapes(nullptr), scratchCells(0), bfsHead(0), pathCache(8 << 20), crowd(options.seed + 1), logger(nullptr), rng(options.seed) // 8MB of cached paths per Graph
 {
     gridSize = size;
+    crowdSize = options.crowdSize;
     //Probably want to pass size down to initMatrix to create a proper sized matrix.
 
-    initLogger();
+    initLogger(options);
     initGraph(blockSize);
-    initMatrix();
-    initWindow();
-    initGui();
-    initSound();
+    initMatrix(options.window);
+    if (options.window) {
+        initWindow();
+        initGui();
+        if (options.music)
+            initSound();
+    }
     initOutside();
 }
 
 Graph::~Graph()
 {
-    delete window;
-    for (size_t i = 0; i < gridSize; i++)
+    delete window; // Null without a window
+
+    // The arenas free the memory, but every shape still owns its vertex array
+    grid.clear();
+    if (shapes)
     {
-        for (size_t j = 0; j < gridSize; j++)
-        {
-            grid[i].erase(grid[i].begin());
-        }
+        for (size_t i = 0; i < gridSize * gridSize; i++)
+            shapes[i].~RectangleShape();
     }
 }
 
 void Graph::run()
 {
-    while (window->isOpen())
+    while (window && window->isOpen())
     {
         pollEvents(); // Listens for any events (eg: inputs)
         update(); // Updates the game
@@ -153,27 +178,50 @@ void Graph::run()
 
 void Graph::update()
 {
+    updateCrowd();
     updateGui();
 }
 
+void Graph::updateCrowd()
+{
+    float seconds = crowdClock.restart().asSeconds();
+    if (!crowdActive)
+        return;
+
+    // Edits and a moved end only mark the field stale, agents follow the new one from here on
+    updateFlowField();
+    sf::Clock stepClock;
+    crowd.step(flowField, std::min(seconds, 0.1f), crowdPool.get()); // A stalled frame (dragging the window) shouldn't fling everyone
+    crowdStepMs = stepClock.getElapsedTime().asSeconds() * 1000.f;
+    if (window)
+        fillCrowdVertices();
+}
+
 void Graph::updateGui()
 {
+    if (!window)
+        return;
+
     // Grid Info 
     std::stringstream ssGridInfo;
     sf::Vector2i position = sf::Mouse::getPosition(*window);
 
-    unsigned int row = (position.y >= debugOffset 
-        && position.y <= debugOffset + (gridSize * blockSize)
-        && position.x > 0 
-        && position.x < (gridSize * blockSize)) // If y is higher than offset, put 0.
-        ? (position.y - debugOffset) / blockSize : 0; 
-    unsigned int col = (position.y >= debugOffset 
-        && position.y <= debugOffset + (gridSize * blockSize)
-        && position.x > 0 
-        && position.x < (gridSize * blockSize)) // If y is higher than offset, put 0.
-        ? (position.x / blockSize) : 0; 
+    bool onGrid = position.y >= debugOffset
+        && position.y < debugOffset + (gridSize * blockSize)
+        && position.x > 0
+        && position.x < (gridSize * blockSize);
+    unsigned int row = onGrid ? (position.y - debugOffset) / blockSize : 0; // If y is higher than offset, put 0.
+    unsigned int col = onGrid ? (position.x / blockSize) : 0;
+
+    // Distance under the mouse, a lookup once the field is built
+    updateFlowField();
+    std::string toEnd = "F";
+    if (flowActive) {
+        unsigned int distance = onGrid ? flowField.distance(row * gridSize + col) : FlowField::UNREACHED;
+        toEnd = distance == FlowField::UNREACHED ? "-" : std::to_string(distance);
+    }
     ssGridInfo << "ROW, COL:  " << row << ", " << col << '\n' <<
-        '\n' <<
+        "To End:      " << toEnd << '\n' <<
         "Start:         " << getStart()->row << "  " << getStart()->col << '\n' <<
         "End:            " << getEnd()->row << "  " << getEnd()->col;
 
@@ -191,18 +239,34 @@ void Graph::updateGui()
         "DFS Search:        D\n" <<
         "BFS Search:        B\n" <<
         "a * Search:         a\n" <<
+        "D* Lite:             L\n" <<
+        "Flow Field:       F\n" <<
+        "Crowd:              G\n" <<
         "Create Maze:     M";
 
     debugTextHotKeyInfo.setString(ssHotkeyInfo.str());
 
     // Path Distance Info
+    updateComponents();
     std::stringstream ssPathDistance;
-    ssPathDistance << "Path Length: " << end->pathDistance;
+    ssPathDistance << "Path Length: " << getPathDistance(end->row, end->col) << '\n' <<
+        "Reachable:     " << (isEndReachable() ? "Yes" : "No") << '\n' <<
+        "Components:  " << components.count() << '\n' <<
+        "Crowd:           ";
+    if (crowdActive)
+        ssPathDistance << crowd.size() << "  " << std::fixed << std::setprecision(1) << crowdStepMs << " ms";
+    else
+        ssPathDistance << "G";
     debugPathDistance.setString(ssPathDistance.str());
 }
 
 void Graph::render()
 {
+    ++frameCount; // Not inside the probe, it compiles away without USDT
+    MAZE_PROBE1(frame__render, frameCount);
+    if (!window)
+        return;
+
     //Always clear first
     window->clear();
 
@@ -210,10 +274,14 @@ void Graph::render()
     {
         for (size_t j = 0; j < gridSize; j++)
         {
-            window->draw(grid[i][j]->shape);
+            window->draw(*grid[i][j]->shape);
         }
     }
 
+    // Every agent in one draw call
+    if (crowdActive)
+        window->draw(crowdVertices, &agentTexture);
+
     //Render GUI last
     renderGui(); 
 
@@ -246,6 +314,8 @@ const Vertex * Graph::getEnd() const
 
 void Graph::pollEvents()
 {
+    if (!window)
+        return;
     sf::Vector2i position = sf::Mouse::getPosition(*window);
 
     while (window->pollEvent(ev))
@@ -276,6 +346,12 @@ void Graph::pollEvents()
                 mazeCreator();
             else if (ev.key.code == sf::Keyboard::A)        // A* path search
                 aStarExplore();
+            else if (ev.key.code == sf::Keyboard::L)        // D* Lite, replans on edits
+                dStarLiteExplore();
+            else if (ev.key.code == sf::Keyboard::F)        // Flow field to end
+                flowFieldExplore();
+            else if (ev.key.code == sf::Keyboard::G)        // Crowd walking to end
+                toggleCrowd();
             break;
         case sf::Event::MouseButtonReleased:                // MAKE Visited, just for mouse prac
             if (ev.key.code == sf::Mouse::Left)
@@ -302,8 +378,16 @@ void Graph::makeVisited(unsigned int row, unsigned int col)
     if (grid[row][col] != start && grid[row][col] != end) {
         if (grid[row][col]->isPath == true)
         {
-            grid[row][col]->shape.setFillColor(sf::Color::White);
+            grid[row][col]->setFillColor(sf::Color::White);
             grid[row][col]->isPath = false;
+
+            unsigned long long oldHash = mazeHash;
+            mazeHash ^= zobristKey(row * gridSize + col);
+            pathCache.wallChanged(oldHash, mazeHash, row * gridSize + col, true);
+            walls.setPath(row * gridSize + col, false);
+            flowDirty = true;
+            if (!componentsDirty)
+                components.closeCell(walls, row * gridSize + col);
         }
     }
 }
@@ -313,9 +397,17 @@ void Graph::makeUnvisited(unsigned int row, unsigned int col)
     if (grid[row][col] != start && grid[row][col] != end) {
         if (grid[row][col]->isPath == false)
         {
-            grid[row][col]->shape.setFillColor(sf::Color::Black);
+            grid[row][col]->setFillColor(sf::Color::Black);
             grid[row][col]->isPath = true;
             setExplosionHole(row, col);
+
+            unsigned long long oldHash = mazeHash;
+            mazeHash ^= zobristKey(row * gridSize + col);
+            pathCache.wallChanged(oldHash, mazeHash, row * gridSize + col, false);
+            walls.setPath(row * gridSize + col, true);
+            flowDirty = true;
+            if (!componentsDirty)
+                components.openCell(walls, row * gridSize + col);
         }
     }
 }
@@ -329,6 +421,10 @@ void Graph::colorVisited(const float& mouseXpos, const float& mouseYpos)
     if (col < gridSize && row < gridSize && mouseYpos  > 0)
     {
         makeVisited(row, col);
+        if (replanActive) {
+            replanner.setWall(row * gridSize + col, !walls.isPath(row * gridSize + col));
+            replan();
+        }
     }
 }
 
@@ -340,6 +436,10 @@ void Graph::colorUnvisited(const float & mouseXpos, const float & mouseYpos)
     if (col < gridSize && row < gridSize && mouseYpos  > 0)
     {
         makeUnvisited(row, col);
+        if (replanActive) {
+            replanner.setWall(row * gridSize + col, !walls.isPath(row * gridSize + col));
+            replan();
+        }
     }
 }
 
@@ -391,6 +491,8 @@ void Graph::updateNeighborsRecursive(Vertex * vertex)
 
 void Graph::setStartSquare()
 {
+    if (!window)
+        return;
     sf::Vector2i position = sf::Mouse::getPosition(*window);
     position.y -= debugOffset; // offset for debug window at top
     if (position.x / blockSize < gridSize && position.x > 0 && position.y / blockSize < gridSize && position.y > 0)
@@ -400,13 +502,18 @@ void Graph::setStartSquare()
             Vertex * temp = start;
             
             this->start = grid[position.y / blockSize][position.x / blockSize]; 
-            start->shape.setFillColor(sf::Color::Green);
+            start->setFillColor(sf::Color::Green);
             start->isPath = false;
-            start->visited = true;
 
-            temp->shape.setFillColor(sf::Color::Black);
-            temp->isPath = true;
-            temp->visited = false;
+            // Back to whatever walls says it is.  isPath = true would open a wall behind every mirror's back
+            temp->isPath = walls.isPath(cellIndex(temp));
+            temp->setFillColor(temp->isPath ? sf::Color::Black : sf::Color::White);
+
+            // The plan is kept, g is distance to end so it holds for any start
+            if (replanActive) {
+                replanner.moveStart(cellIndex(start));
+                replan();
+            }
         }
     }
 
@@ -415,6 +522,8 @@ void Graph::setStartSquare()
 
 void Graph::setEndSquare()
 {
+    if (!window)
+        return;
     sf::Vector2i position = sf::Mouse::getPosition(*window);
     position.y -= debugOffset; // offset for debug window at top
     if (position.x / blockSize < gridSize && position.x > 0 && position.y / blockSize < gridSize && position.y > 0)
@@ -424,9 +533,13 @@ void Graph::setEndSquare()
             Vertex * temp = end;
             this->end = grid[position.y / blockSize][position.x / blockSize];
 
-            end->shape.setFillColor(sf::Color::Red);
+            end->setFillColor(sf::Color::Red);
 
-            temp->shape.setFillColor(sf::Color::Black);
+            // Same as the old start, walls is what the cell really is
+            temp->isPath = walls.isPath(cellIndex(temp));
+            temp->setFillColor(temp->isPath ? sf::Color::Black : sf::Color::White);
+            replanActive = false; // Every g is a distance to the old end
+            flowDirty = true;
         }
     }
     createLog(": Graph::setEndSquare()", MazeLog::FileLogger::e_logType::LOG_INFO);
@@ -438,28 +551,21 @@ void Graph::resetAllSquares()
     {
         for (size_t j = 0; j < gridSize; j++)
         {
-            grid[i][j]->visited = false;
             grid[i][j]->isPath = true;
-            grid[i][j]->shape.setFillColor(sf::Color::Black);
-            grid[i][j]->pathDistance = 0;
+            grid[i][j]->setFillColor(sf::Color::Black);
             grid[i][j]->explosionHole = false;
-            grid[i][j]->aStarParent = nullptr;
-            grid[i][j]->g_cost = INT_MAX;
-            grid[i][j]->h_cost = INT_MAX;
-            grid[i][j]->f_cost = INT_MAX;
         }
     }
 
-    while (!pathStack.empty())
-        pathStack.pop();
-    while (!bfsQueue.empty())
-        bfsQueue.pop();
-    while (!dfsStack.empty())
-        dfsStack.pop();
-    while (!priorityQueue.empty())
-        priorityQueue.pop_back();
-    closedMap.clear();
-    pathVec.clear();
+    resetScratch();
+    search.begin(gridSize * gridSize);
+    mazeHash = zobristBase(gridSize, gridSize); // Cached paths stay, the same layout may come back
+    walls.reset(gridSize, gridSize, true);
+    componentsDirty = true;
+    replanActive = false;
+    flowActive = false;
+    crowdActive = false; // Nothing left to follow
+    crowd.clear();
     randomizeStartEnd();
     initOutside();
     endFound = false;
@@ -471,47 +577,56 @@ void Graph::resetAllSquares()
 void Graph::setDefaultStartEnd()
 {
     start = grid[1][1];
-    start->shape.setFillColor(sf::Color::Green);
+    start->setFillColor(sf::Color::Green);
     start->isPath = false;
-    start->visited = true;
 
     end = grid[gridSize - 2][gridSize - 2];
-    end->shape.setFillColor(sf::Color::Red);
+    end->setFillColor(sf::Color::Red);
 }
 
 void Graph::randomizeStartEnd()
 {
     //Initialize Start
-    int randRow = rand() % (gridSize / 2) + 1;
-    int randCol = rand() % (gridSize / 2) + 1;
+    int randRow = rng() % (gridSize / 2) + 1;
+    int randCol = rng() % (gridSize / 2) + 1;
     start = grid[randRow][randCol];
-    start->shape.setFillColor(sf::Color::Green);
+    start->setFillColor(sf::Color::Green);
     start->isPath = false;
-    start->visited = true;
 
     //Initialize End
-    int randRow2 = (rand() % (gridSize / 2)) + (gridSize / 2) - 1;
-    int randCol2 = (rand() % (gridSize / 2)) + (gridSize / 2) - 1;
+    int randRow2 = (rng() % (gridSize / 2)) + (gridSize / 2) - 1;
+    int randCol2 = (rng() % (gridSize / 2)) + (gridSize / 2) - 1;
     end = grid[randRow2][randCol2];
-    end->shape.setFillColor(sf::Color::Red);
+    end->setFillColor(sf::Color::Red);
 
     createLog(": Graph::randomizeStartEnd()", MazeLog::FileLogger::e_logType::LOG_INFO);
 }
 
 const void Graph::createLog(const std::string&& logLine, MazeLog::FileLogger::e_logType logType)
 {
-    char *ctime_no_newline;
-    time_t tm = time(0);
-    ctime_no_newline = strtok(ctime(&tm), "\n");
-    std::string stringLog(ctime_no_newline);
+    if (!logger)
+        return;
+
+    // Same text as ctime(), without its shared buffer.  Graphs may log from several threads
+    time_t now = time(0);
+    struct tm local;
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char timeText[32];
+    strftime(timeText, sizeof(timeText), "%a %b %d %H:%M:%S %Y", &local);
+    std::string stringLog(timeText);
     stringLog.append(logLine);
-    logger << logType << stringLog;
+    logger->log(logType, stringLog);
 }
 
 unsigned int Graph::getPathDistance(const unsigned int & row, const unsigned int & col)
 {
     if (col < gridSize && col >= 0 && row < gridSize && row >= 0) {
-        return grid[row][col]->pathDistance;
+        unsigned int distance = search.getDistance(row * gridSize + col);
+        return distance == SearchContext::UNREACHED ? 0 : distance;
     }
     return 0;
 }
@@ -519,7 +634,77 @@ unsigned int Graph::getPathDistance(const unsigned int & row, const unsigned int
 void Graph::colorPath(Vertex * vertex)
 {
     if (vertex != start && vertex != end)
-        vertex->shape.setFillColor(sf::Color::Color(255, 140, 0, 255));
+        vertex->setFillColor(sf::Color::Color(255, 140, 0, 255));
+}
+
+bool Graph::isEndReachable()
+{
+    // start / end can be dropped on a wall cell, those have no component but still reach their neighbors
+    if (!walls.isPath(cellIndex(start)) || !walls.isPath(cellIndex(end)))
+        return walls.isReachable(wallScratch, cellIndex(start), cellIndex(end));
+
+    updateComponents();
+    return components.connected(cellIndex(start), cellIndex(end));
+}
+
+void Graph::updateComponents()
+{
+    if (!componentsDirty)
+        return;
+    components.build(walls);
+    componentsDirty = false;
+}
+
+void Graph::resetScratch(bool reserve)
+{
+    // Already sized for this grid, so a search only empties them.  That costs what the last search left, not the grid
+    size_t cells = gridSize * gridSize;
+    if (scratchCells == cells) {
+        bfsQueue.clear();
+        bfsHead = 0;
+        while (!dfsStack.empty())
+            dfsStack.pop();
+        while (!pathStack.empty())
+            pathStack.pop();
+        pathVec.clear();
+        priorityQueue.clear();
+        return;
+    }
+
+    // Drop every container's buffer before the arena takes the memory back
+    ArenaAllocator<Vertex*> allocator(&searchArena);
+    bfsQueue = ArenaVector<Vertex*>(allocator);
+    bfsHead = 0;
+    dfsStack = VertexStack(ArenaVector<Vertex*>(allocator));
+    pathStack = VertexStack(ArenaVector<Vertex*>(allocator));
+    pathVec = ArenaVector<Vertex*>(allocator);
+    priorityQueue = ArenaVector<Vertex*>(allocator);
+    searchArena.reset();
+    if (!reserve)
+        return;
+
+    // Every cell goes into each of them at most once, so after this nothing reallocates mid search
+    bfsQueue.reserve(cells);
+    pathVec.reserve(cells);
+    priorityQueue.reserve(cells);
+    ArenaVector<Vertex*> stackBuffer(allocator);
+    stackBuffer.reserve(cells);
+    dfsStack = VertexStack(std::move(stackBuffer));
+    stackBuffer = ArenaVector<Vertex*>(allocator);
+    stackBuffer.reserve(cells);
+    pathStack = VertexStack(std::move(stackBuffer));
+    scratchCells = cells;
+}
+
+void Graph::beginSearch()
+{
+    resetScratch();
+    search.begin(gridSize * gridSize);
+    search.setVisited(cellIndex(start));
+    search.setDistance(cellIndex(start), 0);
+    expandedCount = 0;
+    endFound = false;
+    replanActive = false;
 }
 
 void Graph::createPath(Vertex * node)
@@ -530,23 +715,24 @@ void Graph::createPath(Vertex * node)
         * Look for a neighbor that has -1 path distance
         * Stop when you find start
     */
-    if (node->pathDistance == 0) {
+    unsigned int distance = search.getDistance(cellIndex(node));
+    if (distance == 0 || distance == SearchContext::UNREACHED) {
         return;
     }
     else {
         if (node == start)
             return;
 
-        std::vector<Vertex *> listNeighbors = {
+        Vertex * listNeighbors[4] = {
             node->top,
             node->left,
             node->bottom,
             node->right
         };
 
-        for (size_t i = 0; i < listNeighbors.size(); ++i) {
+        for (size_t i = 0; i < 4; ++i) {
             if (listNeighbors[i]) {
-                if (listNeighbors[i]->pathDistance == node->pathDistance - 1) {
+                if (search.getDistance(cellIndex(listNeighbors[i])) == distance - 1) {
                     pathStack.emplace(listNeighbors[i]);
                     createPath(listNeighbors[i]);
                     break;
@@ -556,7 +742,7 @@ void Graph::createPath(Vertex * node)
     }
 }
  
-void Graph::displayPath(std::stack<Vertex*> pathStack)
+void Graph::displayPath(VertexStack& pathStack)
 {
     while (!pathStack.empty()) {
         pathVec.emplace_back(pathStack.top());
@@ -568,99 +754,272 @@ void Graph::displayPath(std::stack<Vertex*> pathStack)
 
 void Graph::aStarExplore()
 {
+    if (!start) {
+        std::cout << "ERROR: Set Start Square First!\n";
+        return;
+    }
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_ASTAR, start->row, start->col);
+    beginSearch();
+
+    // Walled off.  The open list would run dry, so don't start the search at all
+    if (!isEndReachable())
+    {
+        MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, 0, 0);
+        createLog(": Graph::aStarExplore() end is not reachable", MazeLog::FileLogger::e_logType::LOG_INFO);
+        return;
+    }
+
+    // Same walls, same start and end.  Just draw the answer
+    SolveResult cached;
+    std::vector<unsigned int> cachedPath;
+    if (pathCache.lookup(mazeHash, Algorithm::AStar, cellIndex(start), cellIndex(end), cached, &cachedPath))
+    {
+        displayCachedPath(cachedPath);
+        search.setDistance(cellIndex(end), cached.pathLength);
+        MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, cached.found, cached.pathLength);
+        createLog(": Graph::aStarExplore() cache hit", MazeLog::FileLogger::e_logType::LOG_INFO);
+        return;
+    }
+
     heapInsert(start);
 
     // Loop.  We will break when current node is end node
     while (true) {
+        // Only if the reachability check was wrong, but an empty open list must not take the program down
         Vertex * currentNode = heapExtractMin();
-        closedMap[cantor(currentNode->row, currentNode->col)] = currentNode;
+        if (!currentNode)
+        {
+            MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, 0, 0);
+            createLog(": Graph::aStarExplore() open list ran dry", MazeLog::FileLogger::e_logType::LOG_INFO);
+            break;
+        }
+        MAZE_PROBE2(node__expand, currentNode->row, currentNode->col);
+        search.setVisited(cellIndex(currentNode)); // Closed
+        ++expandedCount;
 
         // Condition to break loop
         if (currentNode == end)
         {
             createAStarPath(end);
+            MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, 1, getPathDistance(end->row, end->col));
             break;
         }
 
-        std::vector<Vertex *> listNeighbors = {
+        Vertex * listNeighbors[4] = {
             currentNode->top,
             currentNode->left,
             currentNode->bottom,
             currentNode->right
         };
         
-        for (size_t i = 0; i < listNeighbors.size(); ++i) {
+        for (size_t i = 0; i < 4; ++i) {
             // If neighbor is not valid, go to next iteration
             
-            if (!listNeighbors[i]->isPath)
+            if (!listNeighbors[i] || !listNeighbors[i]->isPath)
                 continue;
 
             // If neighbor is already in our closed list, go to next iteration
-            if (closedMap.find(cantor(listNeighbors[i]->row, listNeighbors[i]->col)) != closedMap.end())
+            if (search.isVisited(cellIndex(listNeighbors[i])))
                 continue;
 
-            unsigned int temp_g_cost = currentNode->g_cost + 1; // No diagonals, so this "1" is constant
+            unsigned int temp_g_cost = search.getDistance(cellIndex(currentNode)) + 1; // No diagonals, so this "1" is constant
 
-            // If temp g cost is less (means shorter path from start) OR it is already in priority queue.  EITHER CONDITION enters this
-            // So i need to edit the temp g cost thing... To show that even tho g cost is same, this particular path is sub-optimal
-            // vertex->g_cost = absDiff(vertex->row, start->row) + absDiff(vertex->col, start->col);
-            if (temp_g_cost < listNeighbors[i]->g_cost || std::find(priorityQueue.begin(), priorityQueue.end(), listNeighbors[i]) == priorityQueue.end())
-            {
-                // Not in open (priority queue)
-                listNeighbors[i]->aStarParent = currentNode;
-                updateCosts(listNeighbors[i]);
+            // Only a shorter way in counts.  A cell nobody reached yet reads UNREACHED, so it always gets in
+            unsigned int oldGCost = search.getDistance(cellIndex(listNeighbors[i]));
+            if (temp_g_cost >= oldGCost)
+                continue;
 
-                heapInsert(listNeighbors[i]);
-                makeVisited(listNeighbors[i]);
-                render();
+            search.setParent(cellIndex(listNeighbors[i]), cellIndex(currentNode));
+            updateCosts(listNeighbors[i], temp_g_cost);
+            if (oldGCost != SearchContext::UNREACHED) {
+                // Already open, it just moves up the heap
+                heapDecreaseKey(listNeighbors[i]);
+                continue;
             }
+
+            heapInsert(listNeighbors[i]);
+            colorExplored(listNeighbors[i]);
+            render();
         }
     }
 }
 
+void Graph::dStarLiteExplore()
+{
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_DSTAR_LITE, start->row, start->col);
+    beginSearch();
+    replanPath.clear();
+    replanner.begin(walls, cellIndex(start), cellIndex(end));
+    replanActive = true;
+    replan();
+    createLog(": Graph::dStarLiteExplore()", MazeLog::FileLogger::e_logType::LOG_INFO);
+}
+
+void Graph::replan()
+{
+    // Old plan off first, edited cells already have their wall / path color
+    for (unsigned int cell : replanPath)
+    {
+        Vertex * vertex = grid[cell / gridSize][cell % gridSize];
+        if (vertex != start && vertex != end && walls.isPath(cell))
+            vertex->setFillColor(sf::Color::Black);
+    }
+
+    SolveResult result = replanner.solve(&replanPath);
+    expandedCount = result.expanded;
+    if (!result.found) {
+        replanPath.clear();
+        search.setDistance(cellIndex(end), SearchContext::UNREACHED);
+        MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_DSTAR_LITE, 0, 0);
+        return;
+    }
+
+    for (unsigned int cell : replanPath)
+        colorPath(grid[cell / gridSize][cell % gridSize]);
+    search.setDistance(cellIndex(end), result.pathLength);
+    render();
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_DSTAR_LITE, 1, result.pathLength);
+}
+
+void Graph::flowFieldExplore()
+{
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_FLOW_FIELD, start->row, start->col);
+    beginSearch();
+    flowActive = true;
+    flowDirty = true;
+    updateFlowField();
+
+    std::vector<unsigned int> cells;
+    if (!flowField.path(cellIndex(start), cells)) {
+        MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_FLOW_FIELD, 0, 0);
+        createLog(": Graph::flowFieldExplore() end is not reachable", MazeLog::FileLogger::e_logType::LOG_INFO);
+        return;
+    }
+    for (unsigned int cell : cells)
+        colorPath(grid[cell / gridSize][cell % gridSize]);
+    search.setDistance(cellIndex(end), flowField.distance(cellIndex(start)));
+    render();
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_FLOW_FIELD, 1, flowField.distance(cellIndex(start)));
+    createLog(": Graph::flowFieldExplore()", MazeLog::FileLogger::e_logType::LOG_INFO);
+}
+
+void Graph::updateFlowField()
+{
+    if (!flowActive || !flowDirty)
+        return;
+    flowField.build(walls, cellIndex(end));
+    flowDirty = false;
+}
+
+void Graph::toggleCrowd()
+{
+    if (crowdActive) {
+        crowdActive = false;
+        crowd.clear();
+        createLog(": Graph::toggleCrowd() stopped", MazeLog::FileLogger::e_logType::LOG_INFO);
+        return;
+    }
+
+    flowActive = true;
+    flowDirty = true;
+    updateFlowField();
+    if (!crowdPool)
+        crowdPool.reset(new ThreadPool);
+    crowd.spawn(flowField, crowdSize);
+    crowdActive = true;
+    crowdClock.restart();
+    if (window)
+        fillCrowdVertices();
+    createLog(": Graph::toggleCrowd() " + std::to_string(crowd.size()) + " agents", MazeLog::FileLogger::e_logType::LOG_INFO);
+}
+
+void Graph::fillCrowdVertices()
+{
+    const std::vector<float>& xs = crowd.getX();
+    const std::vector<float>& ys = crowd.getY();
+    const std::vector<unsigned char>& waiting = crowd.getWaiting();
+    crowdVertices.resize(4 * crowd.size());
+
+    float half = blockSize * 0.2f; // Agent is 0.4 blocks wide, the offsets keep it inside its cell
+    float textureSize = static_cast<float>(agentTexture.getSize().x);
+    sf::Color held(255, 120, 120); // Waiting on a full cell
+    for (size_t i = 0; i < crowd.size(); ++i)
+    {
+        float x = xs[i] * blockSize;
+        float y = ys[i] * blockSize + debugOffset;
+        sf::Color color = waiting[i] ? held : sf::Color::White;
+        sf::Vertex * quad = &crowdVertices[4 * i];
+        quad[0] = sf::Vertex(sf::Vector2f(x - half, y - half), color, sf::Vector2f(0.f, 0.f));
+        quad[1] = sf::Vertex(sf::Vector2f(x + half, y - half), color, sf::Vector2f(textureSize, 0.f));
+        quad[2] = sf::Vertex(sf::Vector2f(x + half, y + half), color, sf::Vector2f(textureSize, textureSize));
+        quad[3] = sf::Vertex(sf::Vector2f(x - half, y + half), color, sf::Vector2f(0.f, textureSize));
+    }
+}
+
 void Graph::BFSexplore()
 {
-    if (!start)
+    if (!start) {
         std::cout << "ERROR: Set Start Square First!\n";
-    else
-        this->bfsQueue.emplace(start);
+        return;
+    }
+    beginSearch();
+    this->bfsQueue.emplace_back(start);
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_BFS, start->row, start->col);
+
+    // Different components.  Don't flood the whole region just to find that out
+    if (!isEndReachable())
+    {
+        MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_BFS, 0, 0);
+        createLog(": Graph::BFSexplore() end is not reachable", MazeLog::FileLogger::e_logType::LOG_INFO);
+        return;
+    }
 
-    while (!bfsQueue.empty() && !endFound)
+    while (bfsHead < bfsQueue.size() && !endFound)
     {
-        Vertex * currentNode = bfsQueue.front();
-        bfsQueue.pop();
+        Vertex * currentNode = bfsQueue[bfsHead++];
 
         SearchBFSNeighbors(currentNode);
     } 
 
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_BFS, endFound, getPathDistance(end->row, end->col));
+
     createLog(": Graph::BFSexplore()", MazeLog::FileLogger::e_logType::LOG_INFO);
 
 }
 
 void Graph::makeVisited(Vertex * vertex)
+{
+    colorExplored(vertex);
+    search.setVisited(cellIndex(vertex));
+}
+
+void Graph::colorExplored(Vertex * vertex)
 {
     if (vertex != end)
-        vertex->shape.setFillColor(sf::Color::Blue);
-    vertex->visited = true;
+        vertex->setFillColor(sf::Color::Blue);
 }
 
 void Graph::SearchBFSNeighbors(Vertex * currentNode)
 {
-    std::vector<Vertex *> listNeighbors = { 
+    MAZE_PROBE2(node__expand, currentNode->row, currentNode->col);
+    ++expandedCount;
+
+    Vertex * listNeighbors[4] = { 
         currentNode->left, 
         currentNode->bottom, 
         currentNode->right, 
         currentNode->top
     };
 
-    for (size_t i = 0; i < listNeighbors.size(); ++i) 
+    for (size_t i = 0; i < 4; ++i) 
     {
         // Check that neighbor exists and it's not visited and is valid path
-        if (listNeighbors[i] && !listNeighbors[i]->visited && listNeighbors[i]->isPath)
+        if (listNeighbors[i] && !search.isVisited(cellIndex(listNeighbors[i])) && listNeighbors[i]->isPath)
         {
             makeVisited(listNeighbors[i]);
-            listNeighbors[i]->pathDistance = currentNode->pathDistance + 1;
-            bfsQueue.emplace(listNeighbors[i]);
+            search.setDistance(cellIndex(listNeighbors[i]), search.getDistance(cellIndex(currentNode)) + 1);
+            bfsQueue.emplace_back(listNeighbors[i]);
 
             if (listNeighbors[i] == end) {
                 endFound = true;
@@ -688,9 +1047,24 @@ void Graph::heapInsert(Vertex * vertex)
 {
     priorityQueue.emplace_back(vertex);
     unsigned int index = priorityQueue.size() - 1;
+    MAZE_PROBE1(heap__insert, priorityQueue.size());
 
     // This loop climbs up to the top!
-    while (index != 0 && priorityQueue[index]->f_cost < priorityQueue[getParent(index)]->f_cost)
+    while (index != 0 && fCost(priorityQueue[index]) < fCost(priorityQueue[getParent(index)]))
+    {
+        swap(index, getParent(index));
+        index = getParent(index);
+    }
+}
+
+void Graph::heapDecreaseKey(Vertex * vertex)
+{
+    unsigned int index = static_cast<unsigned int>(std::find(priorityQueue.begin(), priorityQueue.end(), vertex) - priorityQueue.begin());
+    if (index == priorityQueue.size())
+        return;
+
+    // Smaller f than before, so it can only need to climb
+    while (index != 0 && fCost(priorityQueue[index]) < fCost(priorityQueue[getParent(index)]))
     {
         swap(index, getParent(index));
         index = getParent(index);
@@ -704,10 +1078,10 @@ void Graph::MinHeapify(unsigned int index)
     unsigned int smallest = index;
 
     // Get smaller of left and right.  Need to check against size so you don't get vector subscript out of range
-    if (leftChildIndex < priorityQueue.size() && priorityQueue[leftChildIndex]->f_cost < priorityQueue[index]->f_cost)
+    if (leftChildIndex < priorityQueue.size() && fCost(priorityQueue[leftChildIndex]) < fCost(priorityQueue[index]))
         smallest = leftChildIndex;
 
-    if (rightChildIndex < priorityQueue.size() && priorityQueue[rightChildIndex]->f_cost < priorityQueue[index]->f_cost)
+    if (rightChildIndex < priorityQueue.size() && fCost(priorityQueue[rightChildIndex]) < fCost(priorityQueue[index]))
         smallest = rightChildIndex;
 
     // Now do a loop ONLY if one of the children is indeed smaller
@@ -721,6 +1095,7 @@ void Graph::MinHeapify(unsigned int index)
 
 Vertex * Graph::heapExtractMin()
 {
+    MAZE_PROBE1(heap__extract, priorityQueue.size());
     if (priorityQueue.size() <= 0)
         return nullptr;
     else if (priorityQueue.size() == 1) {
@@ -736,10 +1111,11 @@ Vertex * Graph::heapExtractMin()
         // This sorts
         MinHeapify(0);
 
-        // For all the ones sorted with fcost, we need to prioritize ones with lowest hcost
+        // For all the ones sorted with fcost, we need to prioritize ones with lowest hcost.
+        // Only among the ones tied on f, anything else would stop it finding the shortest path
         for (int i = 1; i < priorityQueue.size(); ++i)
         {
-            if (priorityQueue[i]->h_cost < priorityQueue[0]->h_cost)
+            if (fCost(priorityQueue[i]) == fCost(priorityQueue[0]) && hCost(priorityQueue[i]) < hCost(priorityQueue[0]))
                 swap(i, 0);
         }
 
@@ -753,16 +1129,24 @@ unsigned int Graph::absDiff(const unsigned int & valueOne, const unsigned int &
     return result = (result < 0) ? result * (-1) : result;
 }
 
-void Graph::updateCosts(Vertex * vertex)
+void Graph::updateCosts(Vertex * vertex, unsigned int gCost)
 {
-    // G cost is distance from start
-    vertex->g_cost = absDiff(vertex->row, start->row) + absDiff(vertex->col, start->col);
+    // G cost is the length of the best path from start found so far.  H and F follow from it, see hCost() and fCost()
+    search.setDistance(cellIndex(vertex), gCost);
+}
 
+unsigned int Graph::hCost(const Vertex * vertex) const
+{
     // H cost is distance from end
-    vertex->h_cost = absDiff(vertex->row, end->row) + absDiff(vertex->col, end->col);
+    unsigned int rowDiff = vertex->row > end->row ? vertex->row - end->row : end->row - vertex->row;
+    unsigned int colDiff = vertex->col > end->col ? vertex->col - end->col : end->col - vertex->col;
+    return rowDiff + colDiff;
+}
 
+unsigned int Graph::fCost(const Vertex * vertex) const
+{
     // F cost is G + H
-    vertex->f_cost = vertex->g_cost + vertex->h_cost;
+    return search.getDistance(cellIndex(vertex)) + hCost(vertex);
 }
 
 // TODO
@@ -770,10 +1154,17 @@ void Graph::updateCosts(Vertex * vertex)
 // Path distance value does not show
 void Graph::createAStarPath(Vertex * temp)
 {
-    while (temp->aStarParent) {
-        pathStack.push(temp->aStarParent);
-        temp = temp->aStarParent;
+    std::vector<unsigned int> cells; // end back to start, for pathCache
+    cells.push_back(cellIndex(temp));
+    while (search.getParent(cellIndex(temp)) != SearchContext::NO_PARENT) {
+        unsigned int parent = search.getParent(cellIndex(temp));
+        temp = grid[parent / gridSize][parent % gridSize];
+        pathStack.push(temp);
+        cells.push_back(parent);
     }
+    std::reverse(cells.begin(), cells.end());
+    SolveResult result = { true, static_cast<unsigned int>(cells.size() - 1), expandedCount };
+    pathCache.insert(mazeHash, gridSize, gridSize, Algorithm::AStar, cellIndex(start), cellIndex(end), result, cells);
 
     unsigned int counter = 0;
 
@@ -784,35 +1175,52 @@ void Graph::createAStarPath(Vertex * temp)
         render();
         ++counter;
     }
-    end->pathDistance = counter;
+    search.setDistance(cellIndex(end), counter);
     
 }
 
+void Graph::displayCachedPath(const std::vector<unsigned int>& cells)
+{
+    for (unsigned int cell : cells)
+    {
+        colorPath(grid[cell / gridSize][cell % gridSize]);
+        render();
+    }
+}
+
 
 
 void Graph::DFSexplore()
 {
-    if (!start)
+    if (!start) {
         std::cout << "Error: Set Start Square First!\n";
-    else
-        this->dfsStack.emplace(start);
+        return;
+    }
+    beginSearch();
+    this->dfsStack.emplace(start);
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_DFS, start->row, start->col);
 
     DFSrecurse(start, dfsStack);
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_DFS, search.isVisited(cellIndex(end)), dfsStack.size());
     createLog(": Graph::DFSexplore()", MazeLog::FileLogger::e_logType::LOG_INFO);
 }
 
-void Graph::DFSrecurse(Vertex * currentNode, std::stack<Vertex*> stack)
+void Graph::DFSrecurse(Vertex * currentNode, const VertexStack& stack)
 {
-    std::vector<Vertex *> listNeighbors = {
+    MAZE_PROBE2(node__expand, currentNode->row, currentNode->col);
+    ++expandedCount;
+
+    Vertex * listNeighbors[4] = {
         currentNode->left,
         currentNode->bottom,
         currentNode->right,
         currentNode->top
     };
 
-    for (size_t i = 0; i < listNeighbors.size(); i++)
+    for (size_t i = 0; i < 4; i++)
     {
-        if (listNeighbors[i] && !listNeighbors[i]->visited && listNeighbors[i]->isPath)
+        if (listNeighbors[i] && !search.isVisited(cellIndex(listNeighbors[i])) && listNeighbors[i]->isPath)
         {
             makeVisited(listNeighbors[i]);
             dfsStack.emplace(listNeighbors[i]);
@@ -825,13 +1233,15 @@ void Graph::DFSrecurse(Vertex * currentNode, std::stack<Vertex*> stack)
 
 void Graph::mazeCreator()
 {
+    replanActive = false;
+    componentsDirty = true; // Thousands of edits, one build at the end is cheaper than following them
     mazeCreatorRecursive(grid[0][0], grid[gridSize - 1][gridSize - 1]);
+    updateComponents();
 }
 
-unsigned int Graph::randMazeVal(unsigned int length) const
+unsigned int Graph::randMazeVal(unsigned int length)
 {
-    unsigned int randomVal = rand() % 2; // 0, 1
-    unsigned int val;
+    unsigned int randomVal = rng() % 2; // 0, 1
     if (randomVal == 0)
         return (length / 2);
     else 
@@ -842,7 +1252,7 @@ unsigned int Graph::holeMaker(unsigned int RangeOne, unsigned int RangeTwo)
 {
     // Example: Between 25 and 63 >   25 + ( std::rand() % ( 63 - 25 + 1 ) )
     // I am using 25 + 1 + ( std::rand() % ( 63 - 25) ) to not include 25 and 63
-    return RangeOne + 1 + (rand() % (RangeTwo - RangeOne - 1));
+    return RangeOne + 1 + (rng() % (RangeTwo - RangeOne - 1));
 }
 
 void Graph::drawQuadrantLines(Vertex * topLeft, Vertex * botRight, unsigned int midHorizantal, unsigned int midVertical)
@@ -908,6 +1318,7 @@ void Graph::mazeCreatorRecursive(Vertex * topLeft, Vertex * botRight)
     if (areaSize < 30) // If quadrant is less than x size
         return;
     else {
+        MAZE_PROBE4(maze__subdivide, topLeft->row, topLeft->col, botRight->row, botRight->col);
         drawQuadrantLines(topLeft, botRight, midHorizantal, midVertical); // Creates Lines with Spaces on 3/4 sections
         mazeCreatorRecursive(topLeft, grid[midVertical][midHorizantal]); // Top left quadrant
         mazeCreatorRecursive(grid[topLeft->row][midHorizantal], grid[midVertical][botRight->col]); // Top right quadrant
@@ -9,6 +9,8 @@
 #include <iomanip>
 #include <string>
 #include <stack>
+#include <memory>
+#include <random>
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
@@ -16,26 +18,32 @@
 #include <SFML/Audio.hpp>
 
 #include "FileLogger.h"
+#include "probes.h"
+#include "zobrist.h"
+#include "path_cache.h"
+#include "bit_grid.h"
+#include "component_labels.h"
+#include "dstar_lite.h"
+#include "flow_field.h"
+#include "crowd.h"
+#include "thread_pool.h"
+#include "search_context.h"
+#include "arena.h"
 
 //Node.  Uses RectangleShape.  Square is represented as (row, col) in GUI
+//Only the maze lives here.  Search state (visited, distance, parent) is in Graph::search
 struct Vertex
 {
-    sf::RectangleShape shape;
+    sf::RectangleShape * shape; // Null without a window, a headless Graph has nothing to draw
+
+    void setFillColor(const sf::Color& color) { if (shape) shape->setFillColor(color); }
 
     unsigned int col;
     unsigned int row;
     bool haveNeighbors;
 
     bool isPath;
-    bool visited;
     bool explosionHole;
-    unsigned int pathDistance;
-
-    // This is for A star
-    unsigned int g_cost;
-    unsigned int h_cost;
-    unsigned int f_cost;
-    Vertex * aStarParent;
 
     Vertex * top;
     Vertex * bottom;
@@ -43,7 +51,18 @@ struct Vertex
     Vertex * right;
 
     //Simple Constructor
-    Vertex(float xpos, float ypos, float blockSize);
+    Vertex();
+};
+
+// How a Graph is built.  The defaults are the interactive window
+struct GraphOptions
+{
+    bool window = true; // False: no window, fonts, mouse input or shapes.  render() does nothing
+    bool music = true; // Only plays with a window
+    MazeLog::FileLogger * logger = nullptr; // Shared logger, not owned.  Null means the Graph opens logFile itself
+    std::string logFile = "maze_log.txt"; // Empty means no logging
+    unsigned int seed = 0; // Start / end placement and maze generation
+    unsigned int crowdSize = 10000; // Agents G sets walking
 };
 
 class Graph
@@ -52,6 +71,7 @@ private:
     sf::RenderWindow * window;
     float debugOffset; // Offsets Mouse Position to add GUI at top of window.  
     unsigned int mazeDivideCounter; // 0 = no hole, 1-3 makes hole
+    unsigned int frameCount; // Frames rendered.  Only read by the frame__render probe
     bool endFound;
 
     sf::Event ev; // General Event to take player inputs.  Does not need to be initialized
@@ -59,21 +79,68 @@ private:
     unsigned int gridSize; // N x N.  Size of the matrix
     float blockSize; // Length/Width of each individual blocks
 
-    using Matrix = std::vector<std::vector<Vertex*>>;
+    // Every Vertex and grid row lives in gridArena, handed back in one go by ~Graph
+    using Matrix = std::vector<ArenaVector<Vertex*>>;
+    using VertexStack = std::stack<Vertex*, ArenaVector<Vertex*>>;
+    Arena gridArena;
+    Vertex * vertices; // gridSize * gridSize, row major
+    sf::RectangleShape * shapes; // Same layout, only with a window
     Matrix grid;
 
     Vertex * start; // Start Square
     Vertex * end; // End Square
 
+    // Search containers come out of searchArena.  resetScratch() sizes them once, then only empties them
+    Arena searchArena;
+    size_t scratchCells; // Cells the containers are reserved for, 0 until the first search
+
     // Containers to help BFS and DFS.  
-    std::queue<Vertex*> bfsQueue;
-    std::stack<Vertex*> dfsStack;
-    std::stack<Vertex*> pathStack;
-    std::vector<Vertex*> pathVec;
+    ArenaVector<Vertex*> bfsQueue; // Popped by moving bfsHead
+    size_t bfsHead;
+    VertexStack dfsStack;
+    VertexStack pathStack;
+    ArenaVector<Vertex*> pathVec;
 
     // Container for A* algo
-    std::vector<Vertex*> priorityQueue; // Open
-    std::unordered_map<unsigned int, Vertex*> closedMap; // Closed
+    ArenaVector<Vertex*> priorityQueue; // Open.  Closed is search.isVisited()
+
+    // Scratch of the current search, indexed by cellIndex().  distance is BFS depth or A* g cost
+    SearchContext search;
+    unsigned int expandedCount; // Nodes expanded by the last search
+
+    // Finished A* paths, keyed by the wall layout.  Wall edits only drop the paths they affect
+    unsigned long long mazeHash; // Zobrist hash of the walls, kept up to date by makeVisited / makeUnvisited
+    PathCache pathCache;
+
+    // Bit per cell copy of the walls, same upkeep as mazeHash.  Answers "can start reach end" without touching a Vertex
+    BitGrid walls;
+    BitScratch wallScratch;
+
+    // Component of every cell, built from walls.  Single wall edits update it in place, bulk changes
+    // (reset, maze generation) mark it stale and the next question rebuilds it
+    ComponentLabels components;
+    bool componentsDirty;
+
+    // D* Lite plan from the last L search.  While it is active, V / C edits and moving the start replan it in place
+    DStarLite replanner;
+    bool replanActive;
+    std::vector<unsigned int> replanPath; // Cells colored as the current plan
+
+    // Distance / next move to end for every cell, from the last F.  Edits and moving end only mark it stale,
+    // updateGui() rebuilds it when it next shows the distance under the mouse
+    FlowField flowField;
+    bool flowActive;
+    bool flowDirty;
+
+    // Agents walking flowField to end, toggled with G.  update() steps them, render() draws them all in one call
+    Crowd crowd;
+    bool crowdActive;
+    unsigned int crowdSize;
+    std::unique_ptr<ThreadPool> crowdPool; // Made the first time the crowd starts
+    sf::Clock crowdClock; // Time since the last step
+    float crowdStepMs; // Last step, for the GUI
+    sf::Texture agentTexture;
+    sf::VertexArray crowdVertices; // A quad per agent
 
     //GUI
     sf::Font debugFont;
@@ -81,24 +148,28 @@ private:
     sf::Text debugTextHotKeyInfo;
     sf::Text debugPathDistance;
 
-    //Log
-    MazeLog::FileLogger logger;
+    //Log.  Either ownedLogger or injected, null when logging is off
+    MazeLog::FileLogger * logger;
+    std::unique_ptr<MazeLog::FileLogger> ownedLogger;
 
-    //Sound
-    sf::Music music;
+    //Sound.  Null unless music was asked for
+    std::unique_ptr<sf::Music> music;
+
+    //Randomness for start / end and the maze creator.  One per Graph, no global rand()
+    std::mt19937 rng;
 
     //Private Initializers
     void initGraph(float blockSize);
-    void initMatrix();
+    void initMatrix(bool drawn); // drawn: give every Vertex a shape
     void initGui();
     void initSound();
-    void initLogger();
+    void initLogger(const GraphOptions& options);
     void initWindow();
     void initOutside();
 
 public:
     //Constructor and Destructor
-    Graph(unsigned int gridsize, float blockSize);
+    Graph(unsigned int gridsize, float blockSize, const GraphOptions& options = GraphOptions());
     virtual ~Graph();
 
     //Called from main() and starts everything
@@ -107,6 +178,7 @@ public:
     //Update Function
     void update(); // Main Update Function
     void updateGui(); // Runs inside update()
+    void updateCrowd(); // Runs inside update()
 
     //Render Function
     void render(); // Main Render Function
@@ -115,6 +187,9 @@ public:
     //Accessor
     const Vertex * getStart() const;
     const Vertex * getEnd() const;
+    unsigned int getGridSize() const { return gridSize; }
+    bool hasWindow() const { return window != nullptr; }
+    bool isPath(unsigned int row, unsigned int col) const { return grid[row][col]->isPath; }
 
     //General Functions
     void pollEvents();
@@ -133,13 +208,30 @@ public:
     const void createLog(const std::string&& logLine, MazeLog::FileLogger::e_logType logType); // Simple logger.  Creates maze_log.txt in root folder
     unsigned int getPathDistance(const unsigned int& row, const unsigned int& col);
     void colorPath(Vertex * vertex);
+    bool isEndReachable(); // Same component.  Falls back to a flood fill on walls when start or end sits on a wall
+    void updateComponents(); // Rebuilds components if they are stale
+    void beginSearch(); // Forgets the last search.  No per-vertex sweep, the grid is left as drawn
+    void resetScratch(bool reserve = true); // Empties the search containers.  reserve: size them for a whole grid if they aren't yet
 
     //BFS Functions (Djikstra Shortest path)
     void BFSexplore(); 
     void makeVisited(Vertex * vertex);
+    void colorExplored(Vertex * vertex);
     void SearchBFSNeighbors(Vertex * vertex);
     void createPath(Vertex * node); // Start with end node
-    void displayPath(std::stack<Vertex *> pathStack);
+    void displayPath(VertexStack& pathStack); // Empties pathStack into pathVec
+
+    // D* Lite
+    void dStarLiteExplore(); // Plans start -> end from scratch and keeps the plan for replan()
+    void replan(); // Repairs the plan after an edit and redraws the path
+
+    // Flow Field
+    void flowFieldExplore(); // Field to end, then start's path read straight off it
+    void updateFlowField(); // Rebuilds flowField if it is active and stale
+
+    // Crowd
+    void toggleCrowd(); // Spawns crowdSize agents on the flow field to end, or stops them
+    void fillCrowdVertices(); // Agent positions into crowdVertices
 
     // A* Star and Heap
     void aStarExplore();
@@ -149,19 +241,24 @@ public:
     unsigned int cantor(const unsigned int& row, const unsigned int& col) { return (row + col) * (row + col + 1) / 2 + col; }
     void swap(unsigned int index1, unsigned int index2);
     void heapInsert(Vertex * vertex);
+    void heapDecreaseKey(Vertex * vertex); // After its g went down
     void MinHeapify(unsigned int index);
     Vertex * heapExtractMin();
     unsigned int absDiff(const unsigned int& valueOne, const unsigned int& valueTwo);
-    void updateCosts(Vertex * vertex);
+    void updateCosts(Vertex * vertex, unsigned int gCost);
+    unsigned int hCost(const Vertex * vertex) const; // Distance to end
+    unsigned int fCost(const Vertex * vertex) const; // g + h
     void createAStarPath(Vertex * vertex);
+    void displayCachedPath(const std::vector<unsigned int>& cells); // Colors a path that came from pathCache
+    unsigned int cellIndex(const Vertex * vertex) const { return vertex->row * gridSize + vertex->col; }
 
     //DFS Functions
     void DFSexplore(); //Recursive
-    void DFSrecurse(Vertex * vertex, std::stack<Vertex*> stack);
+    void DFSrecurse(Vertex * vertex, const VertexStack& stack);
 
     //Maze Creator (Recursive)
     void mazeCreator();
-    unsigned int randMazeVal(unsigned int size) const;
+    unsigned int randMazeVal(unsigned int size);
     unsigned int holeMaker(unsigned int RangeOne, unsigned int RangeTwo);
     void drawQuadrantLines(Vertex * topLeft, Vertex * botRight, unsigned int midHorizontal, unsigned int midVertical);
     void mazeCreatorRecursive(Vertex * topLeft, Vertex * botRight);
@@ -1,5 +1,6 @@
 #include "graph.h"
 #include "FileLogger.h"
+#include "cli.h"
 
 #include <iostream>
 
@@ -12,6 +13,7 @@
     - Implement GUI
     - Implement BFS
     - Implement DFS
+    - Implement headless batch mode (see cli.h)
 
     Todo:
     - Implement Djikstra to find the shortest path
@@ -22,10 +24,11 @@
 
  */
 
-int main()
+int main(int argc, char * argv[])
 {
-    //Randomize Time Seed
-    std::srand(static_cast<unsigned int>(time(0)));
+    // Any arguments means batch mode.  No window, no audio, no prompts
+    if (argc > 1)
+        return runCli(argc, argv);
 
     float gridSize;
     float blockSize;
@@ -35,7 +38,11 @@ int main()
     std::cout << "Please enter desired BlockSize (Ex: 30): ";
     std::cin >> blockSize;
 
-    Graph graph(gridSize, blockSize); // Grid Size, Block Size
+    //Randomize Time Seed
+    GraphOptions options;
+    options.seed = static_cast<unsigned int>(time(0));
+
+    Graph graph(gridSize, blockSize, options); // Grid Size, Block Size
     graph.run();
     
     return 0;
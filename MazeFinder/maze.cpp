@@ -0,0 +1,297 @@
+#include "maze.h"
+#include "probes.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <fstream>
+
+Maze::Maze() : Maze(0, 0)
+{
+}
+
+Maze::Maze(unsigned int gridSize) : Maze(gridSize, gridSize)
+{
+}
+
+Maze::Maze(unsigned int rows, unsigned int cols)
+{
+    this->rows = rows;
+    this->cols = cols;
+    walls.assign(rows * cols, 0);
+    cells = walls.data();
+    readOnly = false;
+    hash = zobristBase(rows, cols);
+    mazeDivideCounter = 0;
+}
+
+Maze::Maze(const Maze & other)
+    : rows(other.rows), cols(other.cols), walls(other.walls), readOnly(other.readOnly), hash(other.hash), mazeDivideCounter(0)
+{
+    cells = readOnly ? other.cells : walls.data();
+}
+
+Maze::Maze(Maze && other)
+    : rows(other.rows), cols(other.cols), walls(std::move(other.walls)), readOnly(other.readOnly), hash(other.hash), mazeDivideCounter(0)
+{
+    cells = readOnly ? other.cells : walls.data();
+    other.rows = 0;
+    other.cols = 0;
+    other.cells = other.walls.data();
+    other.hash = zobristBase(0, 0);
+}
+
+Maze & Maze::operator=(const Maze & other)
+{
+    if (this != &other) {
+        rows = other.rows;
+        cols = other.cols;
+        walls = other.walls;
+        readOnly = other.readOnly;
+        hash = other.hash;
+        cells = readOnly ? other.cells : walls.data();
+    }
+    return *this;
+}
+
+Maze & Maze::operator=(Maze && other)
+{
+    if (this != &other) {
+        rows = other.rows;
+        cols = other.cols;
+        walls = std::move(other.walls);
+        readOnly = other.readOnly;
+        hash = other.hash;
+        cells = readOnly ? other.cells : walls.data();
+        other.rows = 0;
+        other.cols = 0;
+        other.walls.clear();
+        other.cells = other.walls.data();
+        other.hash = zobristBase(0, 0);
+    }
+    return *this;
+}
+
+Maze Maze::view(unsigned int rows, unsigned int cols, const unsigned char * cells)
+{
+    Maze maze;
+    maze.rows = rows;
+    maze.cols = cols;
+    maze.cells = cells;
+    maze.readOnly = true;
+    maze.computeHash();
+    return maze;
+}
+
+void Maze::computeHash()
+{
+    hash = zobristBase(rows, cols);
+    for (unsigned int i = 0; i < cellCount(); ++i) {
+        if (cells[i])
+            hash ^= zobristKey(i);
+    }
+}
+
+void Maze::setWall(unsigned int row, unsigned int col, bool wall)
+{
+    if (readOnly)
+        return;
+    unsigned int cell = index(row, col);
+    unsigned char value = wall ? 1 : 0;
+    if (walls[cell] != value) {
+        walls[cell] = value;
+        hash ^= zobristKey(cell);
+    }
+}
+
+void Maze::clear()
+{
+    if (readOnly)
+        return;
+    std::fill(walls.begin(), walls.end(), 0);
+    hash = zobristBase(rows, cols);
+}
+
+void Maze::initOutside()
+{
+    if (rows == 0 || cols == 0 || readOnly)
+        return;
+
+    for (unsigned int i = 0; i < cols; ++i) {
+        setWall(0, i, true);
+        setWall(rows - 1, i, true);
+    }
+    for (unsigned int i = 0; i < rows; ++i) {
+        setWall(i, 0, true);
+        setWall(i, cols - 1, true);
+    }
+}
+
+void Maze::generate(unsigned int seed)
+{
+    if (readOnly)
+        return;
+
+    rng.seed(seed);
+    clear();
+    initOutside();
+    explosionHole.assign(rows * cols, 0);
+    mazeDivideCounter = 0;
+
+    if (rows > 0 && cols > 0)
+        mazeCreatorRecursive(0, 0, rows - 1, cols - 1);
+
+    // Only needed while dividing
+    explosionHole.clear();
+    explosionHole.shrink_to_fit();
+}
+
+unsigned int Maze::randomPathCell(std::mt19937& random) const
+{
+    if (cellCount() == 0)
+        return cellCount();
+
+    // Random probing first, then a linear scan so mostly-wall maps still terminate
+    for (unsigned int attempt = 0; attempt < 64; ++attempt) {
+        unsigned int cell = random() % cellCount();
+        if (isPath(cell))
+            return cell;
+    }
+    unsigned int offset = random() % cellCount();
+    for (unsigned int i = 0; i < cellCount(); ++i) {
+        unsigned int cell = (offset + i) % cellCount();
+        if (isPath(cell))
+            return cell;
+    }
+    return cellCount();
+}
+
+unsigned int Maze::randMazeVal(unsigned int length)
+{
+    if (rng() % 2 == 0) // 0, 1
+        return (length / 2);
+    else
+        return (length / 2) + 1;
+}
+
+unsigned int Maze::holeMaker(unsigned int rangeOne, unsigned int rangeTwo)
+{
+    // Strictly between rangeOne and rangeTwo, same as Graph::holeMaker()
+    return rangeOne + 1 + (rng() % (rangeTwo - rangeOne - 1));
+}
+
+void Maze::makeHole(unsigned int row, unsigned int col)
+{
+    setWall(row, col, false);
+
+    // Keep later dividers from closing the hole again
+    explosionHole[index(row, col)] = 1;
+    if (row > 0)
+        explosionHole[index(row - 1, col)] = 1;
+    if (row + 1 < rows)
+        explosionHole[index(row + 1, col)] = 1;
+    if (col > 0)
+        explosionHole[index(row, col - 1)] = 1;
+    if (col + 1 < cols)
+        explosionHole[index(row, col + 1)] = 1;
+}
+
+void Maze::drawQuadrantLines(unsigned int top, unsigned int left, unsigned int bot, unsigned int right, unsigned int midRow, unsigned int midCol)
+{
+    // Make line top to bottom.  COL Doesn't change!
+    for (unsigned int i = top + 1; i < bot; ++i) {
+        if (!explosionHole[index(i, midCol)])
+            setWall(i, midCol, true);
+    }
+
+    // Make line left to right.  ROW Doesn't change!
+    for (unsigned int i = left + 1; i < right; ++i) {
+        if (!explosionHole[index(midRow, i)])
+            setWall(midRow, i, true);
+    }
+
+    // Same rotation as Graph::drawQuadrantLines().  A divider too short to hold a hole is skipped
+    bool holeTop = mazeDivideCounter != 1 && midRow > top + 1;
+    bool holeBot = mazeDivideCounter != 3 && bot > midRow + 1;
+    bool holeLeft = mazeDivideCounter != 0 && midCol > left + 1;
+    bool holeRight = mazeDivideCounter != 2 && right > midCol + 1;
+
+    if (holeTop)
+        makeHole(holeMaker(top, midRow), midCol);
+    if (holeLeft)
+        makeHole(midRow, holeMaker(left, midCol));
+    if (holeBot)
+        makeHole(holeMaker(midRow, bot), midCol);
+    if (holeRight)
+        makeHole(midRow, holeMaker(midCol, right));
+
+    mazeDivideCounter = (mazeDivideCounter + 1) % 4;
+}
+
+void Maze::mazeCreatorRecursive(unsigned int top, unsigned int left, unsigned int bot, unsigned int right)
+{
+    /*
+        Same as Graph::mazeCreatorRecursive()
+        1. Divide into quadrants, with some randomness (Just a 0 or 1 offset)
+        2. Put 1 space in 3 out of the 4 lines
+        3. recurse quadtree. Top left, top right, bot left, bot right
+        4. Exit condition is if the area is X grids or less
+    */
+    unsigned int midCol = left + randMazeVal(right - left);
+    unsigned int midRow = top + randMazeVal(bot - top);
+    unsigned int areaSize = (right - left) * (bot - top);
+    if (areaSize < 30 || midCol > right || midRow > bot)
+        return;
+
+    MAZE_PROBE4(maze__subdivide, top, left, bot, right);
+    drawQuadrantLines(top, left, bot, right, midRow, midCol);
+    mazeCreatorRecursive(top, left, midRow, midCol); // Top left quadrant
+    mazeCreatorRecursive(top, midCol, midRow, right); // Top right quadrant
+    mazeCreatorRecursive(midRow, left, bot, midCol); // Bot left quadrant
+    mazeCreatorRecursive(midRow, midCol, bot, right); // Bot right quadrant
+}
+
+bool Maze::loadFromFile(const std::string & fname)
+{
+    std::ifstream file(fname);
+    if (!file.is_open())
+        return false;
+
+    unsigned int fileRows = 0;
+    unsigned int fileCols = 0;
+    if (!(file >> fileRows >> fileCols))
+        return false;
+
+    std::vector<unsigned char> fileWalls;
+    fileWalls.reserve(fileRows * fileCols);
+    std::string line;
+    for (unsigned int i = 0; i < fileRows; ++i) {
+        if (!(file >> line) || line.size() != fileCols)
+            return false;
+        for (char c : line)
+            fileWalls.push_back(c == '#' ? 1 : 0);
+    }
+
+    rows = fileRows;
+    cols = fileCols;
+    walls.swap(fileWalls);
+    cells = walls.data();
+    readOnly = false;
+    computeHash();
+    return true;
+}
+
+bool Maze::saveToFile(const std::string & fname) const
+{
+    std::ofstream file(fname);
+    if (!file.is_open())
+        return false;
+
+    file << rows << ' ' << cols << '\n';
+    std::string line(cols, '.');
+    for (unsigned int i = 0; i < rows; ++i) {
+        for (unsigned int j = 0; j < cols; ++j)
+            line[j] = isWall(index(i, j)) ? '#' : '.';
+        file << line << '\n';
+    }
+    return file.good();
+}
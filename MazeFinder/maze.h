@@ -0,0 +1,74 @@
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <vector>
+#include <string>
+#include <random>
+
+// Headless maze.  Same (row, col) layout as Graph, but without any SFML state so it can be
+// generated, loaded and solved in batch mode.  Cells are stored row-major, index = row * cols + col.
+// A Maze either owns its cells or is a read only view over memory someone else owns (see shared_maze.h).
+class Maze
+{
+private:
+    unsigned int rows;
+    unsigned int cols;
+    std::vector<unsigned char> walls; // 1 = wall, 0 = path.  Empty for a view
+    const unsigned char * cells; // walls.data(), or the viewed memory
+    bool readOnly;
+    unsigned long long hash; // Zobrist hash of the walls, see zobrist.h
+
+    void computeHash();
+
+    // Maze Creator state
+    std::vector<unsigned char> explosionHole;
+    unsigned int mazeDivideCounter; // Which divider is left without a hole.  Same rotation as Graph
+    std::mt19937 rng;
+
+    //Maze Creator (Recursive)
+    unsigned int randMazeVal(unsigned int length);
+    unsigned int holeMaker(unsigned int rangeOne, unsigned int rangeTwo);
+    void makeHole(unsigned int row, unsigned int col);
+    void drawQuadrantLines(unsigned int top, unsigned int left, unsigned int bot, unsigned int right, unsigned int midRow, unsigned int midCol);
+    void mazeCreatorRecursive(unsigned int top, unsigned int left, unsigned int bot, unsigned int right);
+
+public:
+    //Constructors
+    Maze();
+    Maze(unsigned int gridSize); // N x N, all path
+    Maze(unsigned int rows, unsigned int cols);
+    Maze(const Maze& other);
+    Maze(Maze&& other);
+    Maze& operator= (const Maze& other);
+    Maze& operator= (Maze&& other);
+
+    // Read only view, nothing is copied.  cells must outlive the Maze and every copy of it
+    static Maze view(unsigned int rows, unsigned int cols, const unsigned char * cells);
+
+    //Accessors
+    unsigned int getRows() const { return rows; }
+    unsigned int getCols() const { return cols; }
+    unsigned int cellCount() const { return rows * cols; }
+    unsigned int index(unsigned int row, unsigned int col) const { return row * cols + col; }
+    unsigned int rowOf(unsigned int index) const { return index / cols; }
+    unsigned int colOf(unsigned int index) const { return index % cols; }
+    bool inBounds(unsigned int row, unsigned int col) const { return row < rows && col < cols; }
+    bool isWall(unsigned int index) const { return cells[index] != 0; }
+    bool isPath(unsigned int index) const { return cells[index] == 0; }
+    bool isPath(unsigned int row, unsigned int col) const { return inBounds(row, col) && cells[index(row, col)] == 0; }
+    bool isReadOnly() const { return readOnly; }
+    const unsigned char * data() const { return cells; } // cellCount() bytes, 1 = wall
+    unsigned long long getHash() const { return hash; } // Updated by every edit.  A view is hashed once, when it's made
+
+    //General Functions.  All of them do nothing on a read only view
+    void setWall(unsigned int row, unsigned int col, bool wall);
+    void clear(); // Everything becomes path
+    void initOutside(); // Walls around the border, like Graph::initOutside()
+    void generate(unsigned int seed); // Recursive division, same algorithm as Graph::mazeCreator()
+    unsigned int randomPathCell(std::mt19937& random) const; // Returns cellCount() if there is no path cell
+
+    //File IO.  Text format: "rows cols" then one line per row, '#' = wall, '.' = path
+    bool loadFromFile(const std::string& fname);
+    bool saveToFile(const std::string& fname) const;
+};
+#endif // !MAZE_H
@@ -0,0 +1,297 @@
+#include "movingai.h"
+#include "search_context.h"
+#include "probes.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <climits>
+#include <algorithm>
+
+namespace {
+
+    const double SQRT2 = 1.4142135623730951;
+    const double LENGTH_EPSILON = 1e-3;
+
+    double octileDistance(const Maze& maze, unsigned int from, unsigned int to)
+    {
+        double dRow = std::fabs(static_cast<double>(maze.rowOf(from)) - maze.rowOf(to));
+        double dCol = std::fabs(static_cast<double>(maze.colOf(from)) - maze.colOf(to));
+        return std::max(dRow, dCol) + (SQRT2 - 1.0) * std::min(dRow, dCol);
+    }
+
+    bool isPassable(char c)
+    {
+        return c == '.' || c == 'G' || c == 'S';
+    }
+
+}  // namespace
+
+bool loadMovingAIMap(const std::string & fname, Maze & maze, std::string & error)
+{
+    std::ifstream file(fname);
+    if (!file.is_open()) {
+        error = "Could not open map " + fname;
+        return false;
+    }
+
+    std::string key;
+    std::string type;
+    unsigned int height = 0;
+    unsigned int width = 0;
+    while (file >> key && key != "map")
+    {
+        if (key == "type")
+            file >> type;
+        else if (key == "height")
+            file >> height;
+        else if (key == "width")
+            file >> width;
+        else {
+            error = fname + ": unknown header field " + key;
+            return false;
+        }
+    }
+    if (key != "map" || height == 0 || width == 0) {
+        error = fname + ": missing height / width / map header";
+        return false;
+    }
+
+    Maze loaded(height, width);
+    std::string line;
+    for (unsigned int row = 0; row < height; ++row)
+    {
+        if (!(file >> line) || line.size() < width) {
+            error = fname + ": map row " + std::to_string(row) + " is short";
+            return false;
+        }
+        for (unsigned int col = 0; col < width; ++col)
+        {
+            if (!isPassable(line[col]))
+                loaded.setWall(row, col, true);
+        }
+    }
+
+    maze = std::move(loaded);
+    return true;
+}
+
+bool loadScenarios(const std::string & fname, std::vector<Scenario>& scenarios, std::string & error)
+{
+    std::ifstream file(fname);
+    if (!file.is_open()) {
+        error = "Could not open scenarios " + fname;
+        return false;
+    }
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        if (line.empty() || line[0] == '\r' || line.compare(0, 7, "version") == 0)
+            continue;
+
+        // Tab separated, but map names never contain spaces so plain >> works
+        std::istringstream ss(line);
+        Scenario scenario;
+        if (!(ss >> scenario.bucket >> scenario.mapName >> scenario.width >> scenario.height >>
+            scenario.startX >> scenario.startY >> scenario.goalX >> scenario.goalY >> scenario.optimalLength)) {
+            error = fname + ":" + std::to_string(lineNumber) + ": malformed scenario";
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+    return true;
+}
+
+OctileScratch::OctileScratch()
+    : cellCount(0), epoch(0)
+{
+}
+
+void OctileScratch::begin(unsigned int cellCount)
+{
+    if (this->cellCount != cellCount) {
+        this->cellCount = cellCount;
+        closedStamp.assign(cellCount, 0);
+        touchedStamp.assign(cellCount, 0);
+        gCost.resize(cellCount);
+        steps.resize(cellCount);
+        epoch = 0;
+    }
+    if (++epoch == 0) {
+        std::fill(closedStamp.begin(), closedStamp.end(), 0);
+        std::fill(touchedStamp.begin(), touchedStamp.end(), 0);
+        epoch = 1;
+    }
+    open.clear();
+}
+
+double OctileScratch::getCost(unsigned int cell) const
+{
+    return touchedStamp[cell] == epoch ? gCost[cell] : HUGE_VAL;
+}
+
+void OctileScratch::setCost(unsigned int cell, double cost, unsigned int stepCount)
+{
+    touchedStamp[cell] = epoch;
+    gCost[cell] = cost;
+    steps[cell] = stepCount;
+}
+
+SolveResult solveOctileAStar(const Maze & maze, OctileScratch & scratch, unsigned int start, unsigned int end, double & pathCost)
+{
+    SolveResult result = { false, 0, 0 };
+    pathCost = 0.0;
+    if (start >= maze.cellCount() || end >= maze.cellCount() || maze.isWall(start) || maze.isWall(end))
+        return result;
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_ASTAR, maze.rowOf(start), maze.colOf(start));
+
+    // Costs are real numbers here, so the open list is a plain binary heap on (f, -g)
+    scratch.begin(maze.cellCount());
+    std::vector<OctileScratch::OpenEntry>& open = scratch.open;
+    std::greater<OctileScratch::OpenEntry> later;
+
+    scratch.setCost(start, 0.0, 0);
+    open.push_back({ octileDistance(maze, start, end), { 0.0, start } });
+
+    const int dRows[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    const int dCols[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), later);
+        unsigned int current = open.back().second.second;
+        open.pop_back();
+        if (scratch.isClosed(current))
+            continue;
+        scratch.close(current);
+        ++result.expanded;
+        MAZE_PROBE2(node__expand, maze.rowOf(current), maze.colOf(current));
+
+        if (current == end) {
+            result.found = true;
+            result.pathLength = scratch.getSteps(end);
+            pathCost = scratch.getCost(end);
+            break;
+        }
+
+        unsigned int row = maze.rowOf(current);
+        unsigned int col = maze.colOf(current);
+        double currentCost = scratch.getCost(current);
+        for (int i = 0; i < 8; ++i)
+        {
+            unsigned int nextRow = row + dRows[i];
+            unsigned int nextCol = col + dCols[i];
+            if (!maze.isPath(nextRow, nextCol)) // Wraps around for -1, so also covers the edges
+                continue;
+            // No corner cutting
+            if (i >= 4 && (!maze.isPath(nextRow, col) || !maze.isPath(row, nextCol)))
+                continue;
+
+            unsigned int next = maze.index(nextRow, nextCol);
+            double temp_g_cost = currentCost + (i >= 4 ? SQRT2 : 1.0);
+            if (scratch.isClosed(next) || temp_g_cost >= scratch.getCost(next))
+                continue;
+
+            scratch.setCost(next, temp_g_cost, scratch.getSteps(current) + 1);
+            open.push_back({ temp_g_cost + octileDistance(maze, next, end), { -temp_g_cost, next } });
+            std::push_heap(open.begin(), open.end(), later);
+        }
+    }
+
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, result.found, result.pathLength);
+    return result;
+}
+
+SolveResult solveOctileAStar(const Maze & maze, unsigned int start, unsigned int end, double & pathCost)
+{
+    OctileScratch scratch;
+    return solveOctileAStar(maze, scratch, start, end, pathCost);
+}
+
+bool runScenarios(const Maze & maze, const std::vector<Scenario>& scenarios, const std::string & algoName, std::vector<BucketStats>& buckets, std::ostream * csv)
+{
+    bool octile = (algoName == "astar8");
+    Algorithm algo = Algorithm::AStar;
+    if (!octile)
+        parseAlgorithm(algoName, algo);
+
+    if (csv)
+        *csv << "bucket,start_x,start_y,goal_x,goal_y,reference,length,ok,expanded,micros\n";
+
+    std::map<unsigned int, BucketStats> byBucket;
+    SearchContext context;
+    OctileScratch octileScratch; // Sized once for this map, so per scenario timings are the search alone
+    bool allOk = true;
+    for (const Scenario& scenario : scenarios)
+    {
+        unsigned int start = maze.index(scenario.startY, scenario.startX);
+        unsigned int end = maze.index(scenario.goalY, scenario.goalX);
+        bool inside = maze.inBounds(scenario.startY, scenario.startX) && maze.inBounds(scenario.goalY, scenario.goalX);
+
+        double length = 0.0;
+        SolveResult result = { false, 0, 0 };
+        auto begin = std::chrono::steady_clock::now();
+        if (inside) {
+            if (octile)
+                result = solveOctileAStar(maze, octileScratch, start, end, length);
+            else {
+                result = solve(maze, context, algo, start, end);
+                length = result.pathLength;
+            }
+        }
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+        // Octile must match.  4-connected paths can only be longer than the octile optimum
+        bool ok = result.found && (octile
+            ? std::fabs(length - scenario.optimalLength) <= LENGTH_EPSILON
+            : length + LENGTH_EPSILON >= scenario.optimalLength);
+        allOk = allOk && ok;
+
+        BucketStats& stats = byBucket[scenario.bucket];
+        stats.bucket = scenario.bucket;
+        ++stats.count;
+        stats.mismatches += ok ? 0 : 1;
+        stats.totalMicros += micros;
+        stats.expanded += result.expanded;
+
+        if (csv) {
+            *csv << scenario.bucket << ',' << scenario.startX << ',' << scenario.startY << ',' <<
+                scenario.goalX << ',' << scenario.goalY << ',' << std::setprecision(10) << scenario.optimalLength << ',' <<
+                length << ',' << (ok ? 1 : 0) << ',' << result.expanded << ',' << micros << '\n';
+        }
+    }
+
+    buckets.clear();
+    for (const auto& entry : byBucket)
+        buckets.push_back(entry.second);
+    return allOk;
+}
+
+void printBuckets(std::ostream & out, const std::vector<BucketStats>& buckets)
+{
+    out << std::setw(8) << "bucket" <<
+        std::setw(10) << "count" <<
+        std::setw(12) << "mismatch" <<
+        std::setw(14) << "total ms" <<
+        std::setw(14) << "mean us" <<
+        std::setw(16) << "mean expanded" << '\n';
+
+    for (const BucketStats& stats : buckets)
+    {
+        out << std::setw(8) << stats.bucket <<
+            std::setw(10) << stats.count <<
+            std::setw(12) << stats.mismatches << std::fixed << std::setprecision(2) <<
+            std::setw(14) << stats.totalMicros / 1000.0 <<
+            std::setw(14) << stats.totalMicros / stats.count <<
+            std::setw(16) << std::setprecision(1) << static_cast<double>(stats.expanded) / stats.count << '\n';
+    }
+    out << std::defaultfloat;
+}
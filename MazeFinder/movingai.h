@@ -0,0 +1,89 @@
+#ifndef MOVINGAI_H
+#define MOVINGAI_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "maze.h"
+#include "solver.h"
+
+/*
+    Moving AI grid benchmark format (https://movingai.com/benchmarks/formats.html), read from local disk.
+
+    .map   "type octile", "height H", "width W", "map", then H rows of W chars.
+           '.', 'G' and 'S' are passable, everything else ('@', 'O', 'T', 'W') is a wall.
+    .scen  "version 1", then per line: bucket map width height startX startY goalX goalY optimalLength
+           x is the column, y is the row.  optimalLength is octile: straight = 1, diagonal = sqrt(2)
+
+    mazefinder scen --scen arena.map.scen [--map arena.map] [--algo astar8|astar|bfs|dfs] [--out per_scenario.csv]
+
+    The reference lengths are octile, so only "astar8" (8-connected A*, no corner cutting) is checked
+    for an exact match.  The 4-connected solvers are checked for never beating the reference.
+*/
+
+struct Scenario
+{
+    unsigned int bucket;
+    std::string mapName;
+    unsigned int width;
+    unsigned int height;
+    unsigned int startX; // Col
+    unsigned int startY; // Row
+    unsigned int goalX;
+    unsigned int goalY;
+    double optimalLength;
+};
+
+bool loadMovingAIMap(const std::string& fname, Maze& maze, std::string& error);
+bool loadScenarios(const std::string& fname, std::vector<Scenario>& scenarios, std::string& error);
+
+/*
+    solveOctileAStar scratch, reused across scenarios the way SearchContext is for the 4-connected solvers.
+    Every cell carries the search it was last written in, older stamps read as open / unreached,
+    so begin() is O(1) unless the map size changed or the epoch wrapped.
+*/
+class OctileScratch
+{
+private:
+    unsigned int cellCount;
+    unsigned int epoch;
+    std::vector<unsigned int> closedStamp; // == epoch means closed
+    std::vector<unsigned int> touchedStamp; // == epoch means g / steps were written this search
+    std::vector<double> gCost;
+    std::vector<unsigned int> steps;
+
+public:
+    typedef std::pair<double, std::pair<double, unsigned int>> OpenEntry; // f, (-g, cell)
+    std::vector<OpenEntry> open; // Min heap through std::push_heap / pop_heap with std::greater
+
+    //Constructor
+    OctileScratch();
+
+    void begin(unsigned int cellCount);
+
+    bool isClosed(unsigned int cell) const { return closedStamp[cell] == epoch; }
+    void close(unsigned int cell) { closedStamp[cell] = epoch; }
+    double getCost(unsigned int cell) const; // HUGE_VAL when not reached this search
+    unsigned int getSteps(unsigned int cell) const { return touchedStamp[cell] == epoch ? steps[cell] : 0; }
+    void setCost(unsigned int cell, double cost, unsigned int stepCount);
+};
+
+// 8-connected A* with octile costs.  Diagonals need both orthogonal cells open, as in the benchmark rules
+SolveResult solveOctileAStar(const Maze& maze, OctileScratch& scratch, unsigned int start, unsigned int end, double& pathCost);
+SolveResult solveOctileAStar(const Maze& maze, unsigned int start, unsigned int end, double& pathCost); // Fresh scratch
+
+struct BucketStats
+{
+    unsigned int bucket;
+    unsigned int count;
+    unsigned int mismatches;
+    double totalMicros;
+    unsigned long long expanded;
+};
+
+// Runs every scenario once.  Per scenario CSV goes to csv when it's not null.  Returns false on any mismatch
+bool runScenarios(const Maze& maze, const std::vector<Scenario>& scenarios, const std::string& algoName, std::vector<BucketStats>& buckets, std::ostream * csv);
+void printBuckets(std::ostream& out, const std::vector<BucketStats>& buckets);
+
+#endif // !MOVINGAI_H
@@ -0,0 +1,198 @@
+#include "ms_bfs.h"
+#include "component_labels.h"
+
+#include <algorithm>
+
+const unsigned int MultiSourceBFS::LANES;
+const unsigned int MultiSourceBFS::UNREACHED;
+
+MultiSourceBFS::MultiSourceBFS()
+    : cellCount(0)
+{
+}
+
+void MultiSourceBFS::begin(unsigned int cellCount)
+{
+    // Traversals leave every mask at 0, so this only does work when the maze size changes
+    if (this->cellCount != cellCount) {
+        this->cellCount = cellCount;
+        CellLanes empty = { 0, 0, 0, 0 };
+        cells.assign(cellCount, empty);
+    }
+}
+
+void MultiSourceBFS::resolve(unsigned int cell, std::uint64_t lanes, unsigned int depth, std::vector<unsigned int>& lengths)
+{
+    PendingTarget key = { cell, 0, 0 };
+    auto range = std::equal_range(pending.begin(), pending.end(), key, [](const PendingTarget& a, const PendingTarget& b) {
+        return a.target < b.target;
+    });
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (lanes & (std::uint64_t(1) << it->lane))
+            lengths[it->query] = depth;
+    }
+    cells[cell].targetLanes &= ~lanes;
+}
+
+void MultiSourceBFS::traverse(const Maze & maze, std::vector<unsigned int>& lengths)
+{
+    std::sort(pending.begin(), pending.end(), [](const PendingTarget& a, const PendingTarget& b) {
+        return a.target < b.target;
+    });
+    for (const PendingTarget& query : pending)
+        cells[query.target].targetLanes |= std::uint64_t(1) << query.lane;
+
+    for (unsigned int lane = 0; lane < laneSources.size(); ++lane)
+    {
+        unsigned int start = laneSources[lane];
+        std::uint64_t bit = std::uint64_t(1) << lane;
+        touched.push_back(start);
+        frontier.push_back(start);
+        cells[start].seen = bit;
+        cells[start].visit = bit;
+    }
+    for (unsigned int start : laneSources)
+    {
+        if (cells[start].targetLanes & cells[start].visit)
+            resolve(start, cells[start].targetLanes & cells[start].visit, 0, lengths);
+    }
+
+    // Lanes still looking for at least one end.  A lane stops spreading once all of its ends are found
+    unsigned int cols = maze.getCols();
+    unsigned int depth = 0;
+    auto pendingLanes = [&]() {
+        std::uint64_t lanes = 0;
+        for (const PendingTarget& query : pending)
+            if (lengths[query.query] == UNREACHED)
+                lanes |= std::uint64_t(1) << query.lane;
+        return lanes;
+    };
+    std::uint64_t open = pendingLanes();
+
+    while (!frontier.empty() && open)
+    {
+        ++depth;
+        for (unsigned int cell : frontier)
+        {
+            std::uint64_t lanes = cells[cell].visit & open;
+            cells[cell].visit = 0;
+            if (!lanes)
+                continue;
+
+            unsigned int row = cell / cols;
+            unsigned int col = cell % cols;
+            unsigned int neighbors[4];
+            unsigned int count = 0;
+            if (col > 0)
+                neighbors[count++] = cell - 1;
+            if (row + 1 < maze.getRows())
+                neighbors[count++] = cell + cols;
+            if (col + 1 < cols)
+                neighbors[count++] = cell + 1;
+            if (row > 0)
+                neighbors[count++] = cell - cols;
+
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                unsigned int next = neighbors[i];
+                std::uint64_t added = lanes & ~cells[next].seen;
+                if (!added || maze.isWall(next))
+                    continue;
+                if (cells[next].seen == 0)
+                    touched.push_back(next);
+                if (cells[next].visitNext == 0)
+                    nextFrontier.push_back(next);
+                cells[next].seen |= added;
+                cells[next].visitNext |= added;
+            }
+        }
+
+        bool resolved = false;
+        for (unsigned int cell : nextFrontier)
+        {
+            cells[cell].visit = cells[cell].visitNext;
+            cells[cell].visitNext = 0;
+            if (cells[cell].targetLanes & cells[cell].visit) {
+                resolve(cell, cells[cell].targetLanes & cells[cell].visit, depth, lengths);
+                resolved = true;
+            }
+        }
+        if (resolved)
+            open = pendingLanes();
+        frontier.swap(nextFrontier);
+        nextFrontier.clear();
+    }
+
+    // Put every mask back to 0 for the next traversal
+    for (unsigned int cell : frontier)
+        cells[cell].visit = 0;
+    for (unsigned int cell : touched)
+        cells[cell].seen = 0;
+    for (const PendingTarget& query : pending)
+        cells[query.target].targetLanes = 0;
+    frontier.clear();
+    touched.clear();
+    laneSources.clear();
+    pending.clear();
+}
+
+unsigned int MultiSourceBFS::distinctCells(const std::vector<Query>& queries, bool ends)
+{
+    order.clear();
+    for (const Query& query : queries)
+        order.push_back(ends ? query.end : query.start);
+    std::sort(order.begin(), order.end());
+    return static_cast<unsigned int>(std::unique(order.begin(), order.end()) - order.begin());
+}
+
+void MultiSourceBFS::solveBatch(const Maze & maze, const std::vector<Query>& queries, std::vector<unsigned int>& lengths, const ComponentLabels * components)
+{
+    lengths.assign(queries.size(), UNREACHED);
+    begin(maze.cellCount());
+
+    // Moves are undirected, so a lane can just as well grow from the end.  Key lanes on whichever side has fewer
+    // distinct cells, many queries to one goal then cost one lane like many queries from one start
+    bool fromEnd = distinctCells(queries, true) < distinctCells(queries, false);
+    auto source = [&](unsigned int i) { return fromEnd ? queries[i].end : queries[i].start; };
+    auto target = [&](unsigned int i) { return fromEnd ? queries[i].start : queries[i].end; };
+
+    // Lanes only share work where their waves overlap, so fill each traversal with sources that are close together.
+    // Z-order keeps both rows and columns near each other
+    auto zOrder = [&](unsigned int cell) {
+        std::uint64_t key = 0;
+        unsigned int row = cell / maze.getCols();
+        unsigned int col = cell % maze.getCols();
+        for (unsigned int bit = 0; bit < 32; ++bit)
+            key |= (std::uint64_t((row >> bit) & 1) << (2 * bit + 1)) | (std::uint64_t((col >> bit) & 1) << (2 * bit));
+        return key;
+    };
+    order.clear();
+    for (unsigned int i = 0; i < queries.size(); ++i)
+        order.push_back(i);
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+        return zOrder(source(a)) < zOrder(source(b));
+    });
+
+    for (unsigned int i : order)
+    {
+        const Query& query = queries[i];
+        if (query.start >= maze.cellCount() || query.end >= maze.cellCount() || maze.isWall(query.start) || maze.isWall(query.end))
+            continue;
+        if (components && !components->connected(query.start, query.end))
+            continue;
+
+        // Same source, same lane.  Sources are few per traversal, a linear scan beats a map
+        auto lane = std::find(laneSources.begin(), laneSources.end(), source(i));
+        if (lane == laneSources.end()) {
+            if (laneSources.size() == LANES)
+                traverse(maze, lengths);
+            laneSources.push_back(source(i));
+            lane = laneSources.end() - 1;
+        }
+        PendingTarget pendingTarget = { target(i), static_cast<unsigned int>(lane - laneSources.begin()), i };
+        pending.push_back(pendingTarget);
+    }
+    if (!laneSources.empty())
+        traverse(maze, lengths);
+}
@@ -0,0 +1,71 @@
+#ifndef MS_BFS_H
+#define MS_BFS_H
+
+#include <vector>
+#include <cstdint>
+#include <climits>
+
+#include "maze.h"
+#include "solver.h"
+
+class ComponentLabels; // component_labels.h
+
+/*
+    Multi-source BFS.  Up to 64 starts share one traversal: every cell carries a 64-bit mask with
+    one lane per start, and a single pass over the frontier moves all lanes one layer forward.
+    Cells reached by several starts at the same depth are read and written once instead of once per query.
+
+    solveBatch() answers BFS path lengths for any number of queries.  Queries with the same start share a lane
+    (or the same end, when the batch has fewer distinct ends), so 64 distinct sources go per traversal,
+    and a traversal stops as soon as all of its targets are found.
+    Lanes only save work where their waves meet a cell at the same depth.  Random far apart starts in a long corridor
+    maze rarely do, so the win comes from shared starts / goals and from starts close together.
+    Only lengths come back, no paths.  One object per thread, it keeps its scratch between calls.
+*/
+class MultiSourceBFS
+{
+private:
+    // Everything a traversal touches for one cell, side by side so a neighbor costs one cache line
+    struct CellLanes
+    {
+        std::uint64_t seen; // Lanes that have reached the cell
+        std::uint64_t visit; // Lanes whose current layer includes the cell
+        std::uint64_t visitNext;
+        std::uint64_t targetLanes; // Lanes with a query whose target is the cell
+    };
+
+    unsigned int cellCount;
+    std::vector<CellLanes> cells;
+    std::vector<unsigned int> frontier; // Cells with a non zero visit
+    std::vector<unsigned int> nextFrontier;
+    std::vector<unsigned int> touched; // Cells with a non zero seen
+
+    struct PendingTarget
+    {
+        unsigned int target; // Cell the lane has to reach
+        unsigned int lane;
+        unsigned int query; // Index into the caller's queries
+    };
+    std::vector<unsigned int> laneSources;
+    std::vector<PendingTarget> pending; // This traversal's queries, sorted by target
+    std::vector<unsigned int> order; // Queries by source position
+
+    void begin(unsigned int cellCount);
+    void resolve(unsigned int cell, std::uint64_t lanes, unsigned int depth, std::vector<unsigned int>& lengths);
+    void traverse(const Maze& maze, std::vector<unsigned int>& lengths); // Runs laneSources / pending, then clears them
+    unsigned int distinctCells(const std::vector<Query>& queries, bool ends); // Uses order as scratch
+
+public:
+    static const unsigned int LANES = 64;
+    static const unsigned int UNREACHED = UINT_MAX;
+
+    //Constructor
+    MultiSourceBFS();
+
+    // lengths[i] = BFS moves from queries[i].start to queries[i].end, UNREACHED when there is no path.
+    // Same answers as solveBFS() pathLength.  With components (built for this maze), queries between
+    // components never take a lane, otherwise each one keeps its lane spreading until the whole region is seen
+    void solveBatch(const Maze& maze, const std::vector<Query>& queries, std::vector<unsigned int>& lengths, const ComponentLabels * components = nullptr);
+};
+
+#endif // !MS_BFS_H
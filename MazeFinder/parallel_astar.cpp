@@ -0,0 +1,244 @@
+#include "parallel_astar.h"
+#include "zobrist.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+    unsigned int absDiff(unsigned int valueOne, unsigned int valueTwo)
+    {
+        return valueOne > valueTwo ? valueOne - valueTwo : valueTwo - valueOne;
+    }
+
+    unsigned int manhattan(const Maze& maze, unsigned int from, unsigned int to)
+    {
+        return absDiff(maze.rowOf(from), maze.rowOf(to)) + absDiff(maze.colOf(from), maze.colOf(to));
+    }
+
+}  // namespace
+
+const unsigned int ParallelAStar::Mailbox::CAPACITY;
+const unsigned int ParallelAStar::UNREACHED;
+const unsigned int ParallelAStar::BLOCK;
+const unsigned int ParallelAStar::EXPANSIONS_PER_POLL;
+
+bool ParallelAStar::Mailbox::push(const Message & message)
+{
+    unsigned int last = tail.load(std::memory_order_relaxed);
+    if (last - head.load(std::memory_order_acquire) == CAPACITY)
+        return false;
+    slots[last & (CAPACITY - 1)] = message;
+    tail.store(last + 1, std::memory_order_release);
+    return true;
+}
+
+bool ParallelAStar::Mailbox::pop(Message & message)
+{
+    unsigned int first = head.load(std::memory_order_relaxed);
+    if (first == tail.load(std::memory_order_acquire))
+        return false;
+    message = slots[first & (CAPACITY - 1)];
+    head.store(first + 1, std::memory_order_release);
+    return true;
+}
+
+ParallelAStar::ParallelAStar(ThreadPool & pool)
+    : pool(pool), workerCount(pool.size()), bestLength(UNREACHED), outstanding(0), blocksPerRow(0)
+{
+    workers.resize(workerCount);
+    for (Worker& worker : workers)
+        worker.outbox.resize(workerCount);
+    mailboxes.reset(new Mailbox[static_cast<size_t>(workerCount) * workerCount]);
+}
+
+unsigned int ParallelAStar::ownerOf(const Maze & maze, unsigned int cell) const
+{
+    unsigned int block = (maze.rowOf(cell) / BLOCK) * blocksPerRow + maze.colOf(cell) / BLOCK;
+    return static_cast<unsigned int>(zobristMix(block) % workerCount);
+}
+
+void ParallelAStar::relax(const Maze & maze, Worker & worker, unsigned int end, const Message & message)
+{
+    if (message.g >= context.getDistance(message.cell))
+        return;
+    context.setDistance(message.cell, message.g);
+    context.setParent(message.cell, message.parent);
+
+    unsigned int h = manhattan(maze, message.cell, end);
+    if (message.g + h < bestLength.load(std::memory_order_relaxed))
+        worker.open.heapInsert({ message.g + h, h, message.cell });
+}
+
+void ParallelAStar::send(unsigned int from, unsigned int to, const Message & message)
+{
+    // Counted before it can be seen, so the receiver can never take it in and drop the count first
+    outstanding.fetch_add(1);
+    std::vector<Message>& held = workers[from].outbox[to];
+    if (!held.empty() || !mailboxes[from * workerCount + to].push(message))
+        held.push_back(message);
+}
+
+bool ParallelAStar::flushOutbox(unsigned int from)
+{
+    bool flushed = true;
+    for (unsigned int to = 0; to < workerCount; ++to)
+    {
+        std::vector<Message>& held = workers[from].outbox[to];
+        size_t sent = 0;
+        while (sent < held.size() && mailboxes[from * workerCount + to].push(held[sent]))
+            ++sent;
+        held.erase(held.begin(), held.begin() + sent);
+        flushed = flushed && held.empty();
+    }
+    return flushed;
+}
+
+void ParallelAStar::run(const Maze & maze, unsigned int self, unsigned int end)
+{
+    Worker& worker = workers[self];
+    unsigned int cols = maze.getCols();
+    unsigned int rows = maze.getRows();
+
+    while (true)
+    {
+        // Take in what the others found.  Becoming busy is counted before the messages are let go of
+        long taken = 0;
+        Message message;
+        for (unsigned int from = 0; from < workerCount; ++from)
+        {
+            if (from == self)
+                continue;
+            Mailbox& mailbox = mailboxes[from * workerCount + self];
+            while (mailbox.pop(message))
+            {
+                if (!worker.busy) {
+                    worker.busy = true;
+                    outstanding.fetch_add(1);
+                }
+                relax(maze, worker, end, message);
+                ++taken;
+            }
+        }
+        if (taken)
+            outstanding.fetch_sub(taken);
+        flushOutbox(self);
+
+        HeapNode current;
+        unsigned int expansions = 0;
+        while (expansions < EXPANSIONS_PER_POLL && worker.open.heapExtractMin(current))
+        {
+            // Nothing left in this heap can beat the goal already found
+            if (current.f_cost >= bestLength.load(std::memory_order_relaxed)) {
+                worker.open.clear();
+                break;
+            }
+
+            // Stale entry, the cell was reached cheaper since
+            unsigned int g = current.f_cost - current.h_cost;
+            if (g > context.getDistance(current.cell))
+                continue;
+            ++expansions;
+            ++worker.expanded;
+
+            if (current.cell == end) {
+                unsigned int best = bestLength.load();
+                while (g < best && !bestLength.compare_exchange_weak(best, g))
+                    ;
+                continue;
+            }
+
+            unsigned int cell = current.cell;
+            unsigned int row = cell / cols;
+            unsigned int col = cell % cols;
+            unsigned int neighbors[4];
+            unsigned int count = 0;
+            if (col > 0)
+                neighbors[count++] = cell - 1;
+            if (row + 1 < rows)
+                neighbors[count++] = cell + cols;
+            if (col + 1 < cols)
+                neighbors[count++] = cell + 1;
+            if (row > 0)
+                neighbors[count++] = cell - cols;
+
+            unsigned int parent = context.getParent(cell);
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                unsigned int next = neighbors[i];
+                if (next == parent || maze.isWall(next))
+                    continue;
+                Message found = { next, g + 1, cell };
+                unsigned int owner = ownerOf(maze, next);
+                if (owner == self)
+                    relax(maze, worker, end, found);
+                else
+                    send(self, owner, found);
+            }
+        }
+
+        if (worker.open.empty()) {
+            if (worker.busy) {
+                worker.busy = false;
+                outstanding.fetch_sub(1);
+            }
+            if (outstanding.load() == 0)
+                break;
+            std::this_thread::yield();
+        }
+    }
+}
+
+SolveResult ParallelAStar::solve(const Maze & maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SolveResult result = { false, 0, 0 };
+    if (start >= maze.cellCount() || end >= maze.cellCount() || maze.isWall(start) || maze.isWall(end))
+        return result;
+
+    context.begin(maze.cellCount());
+    blocksPerRow = (maze.getCols() + BLOCK - 1) / BLOCK;
+    bestLength.store(UNREACHED);
+    for (Worker& worker : workers)
+    {
+        worker.open.clear();
+        worker.expanded = 0;
+        worker.busy = false;
+    }
+
+    // start's owner begins busy, everyone else waits for a message
+    Worker& first = workers[ownerOf(maze, start)];
+    first.busy = true;
+    outstanding.store(1);
+    context.setDistance(start, 0);
+    context.setParent(start, start);
+    unsigned int h = manhattan(maze, start, end);
+    first.open.heapInsert({ h, h, start });
+
+    // One task per worker, each one keeps its thread until the whole search is done
+    for (unsigned int self = 0; self < workerCount; ++self)
+    {
+        pool.enqueue([this, &maze, self, end](unsigned int) {
+            run(maze, self, end);
+        });
+    }
+    pool.wait();
+
+    for (const Worker& worker : workers)
+        result.expanded += worker.expanded;
+    if (bestLength.load() == UNREACHED)
+        return result;
+
+    // Every parent has a smaller g than its child, so the walk ends at start after exactly bestLength moves
+    result.found = true;
+    result.pathLength = bestLength.load();
+    if (path) {
+        path->clear();
+        for (unsigned int cell = end; ; cell = context.getParent(cell)) {
+            path->push_back(cell);
+            if (cell == start)
+                break;
+        }
+        std::reverse(path->begin(), path->end());
+    }
+    return result;
+}
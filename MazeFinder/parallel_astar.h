@@ -0,0 +1,101 @@
+#ifndef PARALLEL_ASTAR_H
+#define PARALLEL_ASTAR_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <climits>
+
+#include "maze.h"
+#include "solver.h"
+#include "search_context.h"
+#include "thread_pool.h"
+
+/*
+    Hash distributed A* (HDA*) for single very large queries.  Every cell has an owner worker, picked by hashing
+    the BLOCK x BLOCK square it is in, so most moves stay inside one worker.  A worker only ever expands its own cells
+    off its own MinHeap, and only it writes their g cost / parent in the shared SearchContext.
+    A neighbor owned by someone else is sent to them through the mailbox for that (sender, receiver) pair,
+    a lock-free single producer / single consumer ring.
+
+    Workers expand out of global f order, so a cell can get a cheaper g after it was expanded.  Heap entries whose
+    g is above the cell's current one are stale and skipped, a cheaper message simply reopens the cell.
+    The first goal found is only an upper bound: workers keep going until nothing with f below it is left.
+
+    Termination counts outstanding work, one per busy worker and one per message not yet taken in.
+    A worker goes idle when its heap has nothing below the bound, and only a message can make it busy again,
+    so once the count hits 0 the search is over and the bound is the optimal length.
+
+    Needs every pool worker at once, the workers spin while they wait for messages.
+*/
+class ParallelAStar
+{
+private:
+    struct Message
+    {
+        unsigned int cell;
+        unsigned int g;
+        unsigned int parent;
+    };
+
+    // Single producer / single consumer ring.  Padding keeps head and tail off each other's cache line
+    struct Mailbox
+    {
+        static const unsigned int CAPACITY = 1024; // Power of two
+
+        std::atomic<unsigned int> head; // Next slot to read, written by the receiver
+        char headPadding[64];
+        std::atomic<unsigned int> tail; // Next slot to write, written by the sender
+        char tailPadding[64];
+        Message slots[CAPACITY];
+
+        Mailbox() : head(0), tail(0) {}
+        bool push(const Message& message);
+        bool pop(Message& message);
+    };
+
+    // Everything one worker keeps to itself
+    struct Worker
+    {
+        MinHeap open;
+        std::vector<std::vector<Message>> outbox; // Per receiver, messages that found the mailbox full
+        unsigned int expanded;
+        bool busy;
+    };
+
+    ThreadPool& pool;
+    unsigned int workerCount;
+    SearchContext context; // distance = g cost, parent.  A cell's entries are only touched by its owner
+    std::vector<Worker> workers;
+    std::unique_ptr<Mailbox[]> mailboxes; // [from * workerCount + to]
+
+    std::atomic<unsigned int> bestLength; // Cheapest goal found so far, UNREACHED until then
+    std::atomic<long> outstanding; // Busy workers + messages not yet taken in
+
+    unsigned int blocksPerRow;
+    unsigned int ownerOf(const Maze& maze, unsigned int cell) const;
+
+    void relax(const Maze& maze, Worker& worker, unsigned int end, const Message& message);
+    void send(unsigned int from, unsigned int to, const Message& message);
+    bool flushOutbox(unsigned int from); // True when every held back message went out
+    void run(const Maze& maze, unsigned int self, unsigned int end);
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+    static const unsigned int BLOCK = 16; // Cells per side of the squares that are hashed to owners
+    static const unsigned int EXPANSIONS_PER_POLL = 64; // Nodes expanded between mailbox checks
+
+    //Constructor
+    explicit ParallelAStar(ThreadPool& pool);
+
+    // Same answer as solveAStar(): found, shortest pathLength, and the path when asked.
+    // expanded counts every expansion, a reopened cell counts again
+    SolveResult solve(const Maze& maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+
+    // Make it Non Copyable
+    ParallelAStar(const ParallelAStar &) = delete;
+    ParallelAStar &operator= (const ParallelAStar &) = delete;
+};
+
+#endif // !PARALLEL_ASTAR_H
@@ -0,0 +1,285 @@
+#include "parallel_bfs.h"
+
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    // Lowest set bit, bits must not be 0
+    unsigned int lowestBit(std::uint64_t bits)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return index;
+#else
+        return __builtin_ctzll(bits);
+#endif
+    }
+
+    unsigned int popCount(std::uint64_t bits)
+    {
+#if defined(_MSC_VER)
+        return static_cast<unsigned int>(__popcnt64(bits));
+#else
+        return __builtin_popcountll(bits);
+#endif
+    }
+
+}  // namespace
+
+const unsigned int ParallelBFS::UNREACHED;
+const size_t ParallelBFS::MIN_PARALLEL_FRONTIER;
+const size_t ParallelBFS::MIN_CHUNK;
+const size_t ParallelBFS::TOP_DOWN_ALPHA;
+const size_t ParallelBFS::BOTTOM_UP_BETA;
+
+ParallelBFS::ParallelBFS(ThreadPool & pool)
+    : pool(pool), cellCount(0), lastFrontierCount(0)
+{
+    nextFrontiers.resize(pool.size());
+}
+
+bool ParallelBFS::claim(unsigned int cell)
+{
+    std::atomic<std::uint64_t>& word = visited[cell / 64];
+    std::uint64_t bit = std::uint64_t(1) << (cell % 64);
+
+    // Plain load first, most neighbors were visited long ago and a locked or would bounce the line for nothing
+    if (word.load(std::memory_order_relaxed) & bit)
+        return false;
+    return (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+}
+
+void ParallelBFS::expand(const Maze & maze, size_t first, size_t last, unsigned int depth, std::vector<unsigned int>& distance, std::vector<unsigned int>& next)
+{
+    unsigned int cols = maze.getCols();
+    unsigned int rows = maze.getRows();
+    for (size_t i = first; i < last; ++i)
+    {
+        unsigned int cell = frontier[i];
+        unsigned int row = cell / cols;
+        unsigned int col = cell % cols;
+        unsigned int neighbors[4];
+        unsigned int count = 0;
+
+        // Same order as solveBFS, not that it changes any distance
+        if (col > 0)
+            neighbors[count++] = cell - 1;
+        if (row + 1 < rows)
+            neighbors[count++] = cell + cols;
+        if (col + 1 < cols)
+            neighbors[count++] = cell + 1;
+        if (row > 0)
+            neighbors[count++] = cell - cols;
+
+        for (unsigned int n = 0; n < count; ++n)
+        {
+            if (maze.isPath(neighbors[n]) && claim(neighbors[n])) {
+                distance[neighbors[n]] = depth;
+                next.push_back(neighbors[n]);
+            }
+        }
+    }
+}
+
+void ParallelBFS::topDownStep(const Maze & maze, unsigned int depth, std::vector<unsigned int>& distance)
+{
+    if (frontier.size() < MIN_PARALLEL_FRONTIER || pool.size() == 1) {
+        std::vector<unsigned int>& next = nextFrontiers[0];
+        next.clear();
+        expand(maze, 0, frontier.size(), depth, distance, next);
+        frontier.swap(next);
+        return;
+    }
+
+    // A few chunks per worker so one slow chunk doesn't hold the whole level up
+    size_t chunk = std::max(MIN_CHUNK, frontier.size() / (pool.size() * 4) + 1);
+    for (std::vector<unsigned int>& next : nextFrontiers)
+        next.clear();
+    for (size_t first = 0; first < frontier.size(); first += chunk)
+    {
+        size_t last = std::min(frontier.size(), first + chunk);
+        pool.enqueue([&, first, last, depth](unsigned int worker) {
+            expand(maze, first, last, depth, distance, nextFrontiers[worker]);
+        });
+    }
+    pool.wait();
+
+    frontier.clear();
+    for (const std::vector<unsigned int>& next : nextFrontiers)
+        frontier.insert(frontier.end(), next.begin(), next.end());
+}
+
+size_t ParallelBFS::bottomUp(const Maze & maze, size_t first, size_t last, unsigned int depth, std::vector<unsigned int>& distance)
+{
+    unsigned int cols = maze.getCols();
+    unsigned int rows = maze.getRows();
+    size_t found = 0;
+    for (size_t i = first; i < last; ++i)
+    {
+        unsigned int word = openWords[i];
+        // Words are owned by one task, so visited needs no read-modify-write here
+        std::uint64_t candidates = pathBits[word] & ~visited[word].load(std::memory_order_relaxed);
+        std::uint64_t added = 0;
+        for (; candidates; candidates &= candidates - 1)
+        {
+            unsigned int bit = lowestBit(candidates);
+            unsigned int cell = static_cast<unsigned int>(word * 64 + bit);
+            unsigned int row = cell / cols;
+            unsigned int col = cell % cols;
+
+            // Any parent will do, stop at the first one in the frontier
+            if ((col > 0 && inFrontier(cell - 1)) ||
+                (row + 1 < rows && inFrontier(cell + cols)) ||
+                (col + 1 < cols && inFrontier(cell + 1)) ||
+                (row > 0 && inFrontier(cell - cols)))
+            {
+                added |= std::uint64_t(1) << bit;
+                distance[cell] = depth;
+            }
+        }
+        nextBits[word] = added;
+        if (added) {
+            visited[word].store(visited[word].load(std::memory_order_relaxed) | added, std::memory_order_relaxed);
+            found += popCount(added);
+        }
+    }
+    return found;
+}
+
+size_t ParallelBFS::bottomUpStep(const Maze & maze, unsigned int depth, std::vector<unsigned int>& distance)
+{
+    size_t words = openWords.size();
+    size_t found = 0;
+    if (words * 64 < MIN_PARALLEL_FRONTIER || pool.size() == 1) {
+        found = bottomUp(maze, 0, words, depth, distance);
+    }
+    else {
+        taskCounts.assign(pool.size() * 4, 0);
+        size_t chunk = words / taskCounts.size() + 1;
+        for (size_t task = 0; task < taskCounts.size(); ++task)
+        {
+            size_t first = std::min(words, task * chunk);
+            size_t last = std::min(words, first + chunk);
+            pool.enqueue([&, first, last, task, depth](unsigned int) {
+                taskCounts[task] = bottomUp(maze, first, last, depth, distance);
+            });
+        }
+        pool.wait();
+        for (size_t count : taskCounts)
+            found += count;
+    }
+
+    // Only words in frontierWords can be non zero, so clearing them leaves a zero bitmap for the next level.
+    // The new frontier can only be in the words just scanned, then words with nothing left to visit drop out
+    for (unsigned int word : frontierWords)
+        frontierBits[word] = 0;
+    frontierBits.swap(nextBits);
+    frontierWords.assign(openWords.begin(), openWords.end());
+    size_t kept = 0;
+    for (unsigned int word : frontierWords)
+    {
+        if (pathBits[word] & ~visited[word].load(std::memory_order_relaxed))
+            openWords[kept++] = word;
+    }
+    openWords.resize(kept);
+    return found;
+}
+
+void ParallelBFS::frontierToBits()
+{
+    frontierWords.clear();
+    for (unsigned int cell : frontier)
+    {
+        if (frontierBits[cell / 64] == 0)
+            frontierWords.push_back(cell / 64);
+        frontierBits[cell / 64] |= std::uint64_t(1) << (cell % 64);
+    }
+
+    openWords.clear();
+    for (unsigned int word = 0; word < pathBits.size(); ++word)
+    {
+        if (pathBits[word] & ~visited[word].load(std::memory_order_relaxed))
+            openWords.push_back(word);
+    }
+}
+
+void ParallelBFS::bitsToFrontier()
+{
+    frontier.clear();
+    for (unsigned int word : frontierWords)
+    {
+        for (std::uint64_t bits = frontierBits[word]; bits; bits &= bits - 1)
+            frontier.push_back(word * 64 + lowestBit(bits));
+        frontierBits[word] = 0;
+    }
+    frontierWords.clear();
+}
+
+void ParallelBFS::distances(const Maze & maze, unsigned int start, std::vector<unsigned int>& distance, BfsDirection direction)
+{
+    distance.assign(maze.cellCount(), UNREACHED);
+    if (start >= maze.cellCount() || maze.isWall(start))
+        return;
+
+    size_t words = (maze.cellCount() + 63) / 64;
+    if (cellCount != maze.cellCount()) {
+        cellCount = maze.cellCount();
+        visited.reset(new std::atomic<std::uint64_t>[words]);
+    }
+    for (size_t i = 0; i < words; ++i)
+        visited[i].store(0, std::memory_order_relaxed);
+
+    // Bottom up scans the unvisited path cells, so it needs them as bits
+    size_t pathCount = maze.cellCount();
+    if (direction == BfsDirection::Optimizing) {
+        pathBits.assign(words, 0);
+        frontierBits.assign(words, 0);
+        nextBits.assign(words, 0);
+        pathCount = 0;
+        const unsigned char * cells = maze.data();
+        for (unsigned int cell = 0; cell < maze.cellCount(); ++cell)
+            pathBits[cell / 64] |= std::uint64_t(cells[cell] == 0) << (cell % 64);
+        for (std::uint64_t bits : pathBits)
+            pathCount += popCount(bits);
+    }
+
+    frontier.clear();
+    frontier.push_back(start);
+    claim(start);
+    distance[start] = 0;
+
+    // Beamer's switch: go bottom up once the frontier is a large share of what's left to visit, back to top down when
+    // a shrinking frontier is a small share of it again.  Beamer compares the way back against the whole graph, but a grid
+    // frontier is always tiny next to the whole map and that flips straight back every level
+    bool bottomUpMode = false;
+    size_t frontierCount = 1;
+    size_t visitedCount = 1;
+    for (unsigned int depth = 1; frontierCount > 0; ++depth)
+    {
+        if (direction == BfsDirection::Optimizing) {
+            size_t unvisited = pathCount - visitedCount;
+            if (!bottomUpMode && frontierCount > unvisited / TOP_DOWN_ALPHA) {
+                frontierToBits();
+                bottomUpMode = true;
+            }
+            else if (bottomUpMode && frontierCount < unvisited / BOTTOM_UP_BETA && frontierCount < lastFrontierCount) {
+                bitsToFrontier();
+                bottomUpMode = false;
+            }
+        }
+        lastFrontierCount = frontierCount;
+
+        if (bottomUpMode) {
+            frontierCount = bottomUpStep(maze, depth, distance);
+        }
+        else {
+            topDownStep(maze, depth, distance);
+            frontierCount = frontier.size();
+        }
+        visitedCount += frontierCount;
+    }
+}
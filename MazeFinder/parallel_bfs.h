@@ -0,0 +1,79 @@
+#ifndef PARALLEL_BFS_H
+#define PARALLEL_BFS_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <climits>
+
+#include "maze.h"
+#include "thread_pool.h"
+
+/*
+    Level synchronous BFS for whole distance fields (every cell's distance from one start).
+    Each level's frontier is cut into chunks that run on the pool.  A worker claims a cell by setting its bit
+    in the shared visited bitmap with fetch_or, so exactly one worker writes each distance, and appends it to its
+    own next frontier buffer.  pool.wait() between levels is the only synchronization.
+
+    Small frontiers (corridor mazes mostly have them) are expanded on the calling thread, a pool round trip
+    per level would cost more than the level itself.  Distances are the same as solveBFS() in any case.
+
+    BfsDirection::Optimizing switches levels to bottom up once the frontier gets large (open maps, a few levels in):
+    every unvisited path cell checks its 4 neighbors in a frontier bitmap and stops at the first hit, instead of every
+    frontier cell pushing to neighbors that are mostly visited already.  Bottom up tasks own whole words of the
+    bitmaps, so no atomics there.  It goes back to top down when the frontier shrinks again.
+*/
+enum class BfsDirection
+{
+    TopDown,
+    Optimizing
+};
+
+class ParallelBFS
+{
+private:
+    ThreadPool& pool;
+    unsigned int cellCount;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> visited; // Bit per cell
+    std::vector<unsigned int> frontier;
+    std::vector<std::vector<unsigned int>> nextFrontiers; // One per worker
+
+    // Bottom up levels only
+    std::vector<std::uint64_t> pathBits; // Bit per path cell
+    std::vector<std::uint64_t> frontierBits;
+    std::vector<std::uint64_t> nextBits;
+    std::vector<unsigned int> frontierWords; // Words of frontierBits that may be non zero
+    std::vector<unsigned int> openWords; // Words that still have unvisited path cells
+    std::vector<size_t> taskCounts; // Cells found per bottom up task
+    size_t lastFrontierCount;
+
+    bool claim(unsigned int cell); // True for the one caller that marks cell visited
+    void expand(const Maze& maze, size_t first, size_t last, unsigned int depth, std::vector<unsigned int>& distance, std::vector<unsigned int>& next);
+    void topDownStep(const Maze& maze, unsigned int depth, std::vector<unsigned int>& distance); // frontier -> frontier
+
+    bool inFrontier(unsigned int cell) const { return (frontierBits[cell / 64] >> (cell % 64)) & 1; }
+    size_t bottomUp(const Maze& maze, size_t first, size_t last, unsigned int depth, std::vector<unsigned int>& distance);
+    size_t bottomUpStep(const Maze& maze, unsigned int depth, std::vector<unsigned int>& distance); // frontierBits -> frontierBits, returns its count
+    void frontierToBits();
+    void bitsToFrontier();
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+    static const size_t MIN_PARALLEL_FRONTIER = 4096; // Smaller levels stay on the calling thread
+    static const size_t MIN_CHUNK = 1024; // Cells per task
+    static const size_t TOP_DOWN_ALPHA = 14; // Bottom up once frontier > unvisited / ALPHA
+    static const size_t BOTTOM_UP_BETA = 24; // Top down again once a shrinking frontier < unvisited / BETA
+
+    //Constructor
+    explicit ParallelBFS(ThreadPool& pool);
+
+    // distance[cell] = BFS moves from start, UNREACHED for walls and cells start can't get to.  Resized to cellCount()
+    void distances(const Maze& maze, unsigned int start, std::vector<unsigned int>& distance, BfsDirection direction = BfsDirection::Optimizing);
+
+    // Make it Non Copyable
+    ParallelBFS(const ParallelBFS &) = delete;
+    ParallelBFS &operator= (const ParallelBFS &) = delete;
+};
+
+#endif // !PARALLEL_BFS_H
@@ -0,0 +1,236 @@
+#include "parallel_dfs.h"
+
+#include <algorithm>
+#include <thread>
+
+const unsigned int ParallelDFS::NO_REGION;
+const unsigned int ParallelDFS::SERIAL_LIMIT;
+
+ParallelDFS::ParallelDFS(ThreadPool & pool)
+    : pool(pool), workerCount(pool.size()), cellCount(0), active(0), labels(nullptr), label(NO_REGION), collectDeadEnds(false)
+{
+    workers.reset(new Worker[workerCount]);
+}
+
+void ParallelDFS::begin(unsigned int cellCount)
+{
+    size_t words = (static_cast<size_t>(cellCount) + 63) / 64;
+    if (this->cellCount != cellCount) {
+        this->cellCount = cellCount;
+        visited.reset(new std::atomic<std::uint64_t>[words]);
+    }
+    for (size_t i = 0; i < words; ++i)
+        visited[i].store(0, std::memory_order_relaxed);
+    for (unsigned int i = 0; i < workerCount; ++i)
+        workers[i].deadEnds.clear();
+}
+
+bool ParallelDFS::claim(unsigned int cell)
+{
+    std::atomic<std::uint64_t>& word = visited[cell / 64];
+    std::uint64_t bit = std::uint64_t(1) << (cell % 64);
+
+    // Plain load first, most neighbors were claimed already and a locked or would bounce the line for nothing
+    if (word.load(std::memory_order_relaxed) & bit)
+        return false;
+    return (word.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+}
+
+void ParallelDFS::visit(const Maze & maze, Worker & worker, unsigned int cell)
+{
+    ++worker.count;
+    if (labels)
+        labels[cell] = label;
+
+    unsigned int cols = maze.getCols();
+    unsigned int row = cell / cols;
+    unsigned int col = cell % cols;
+    unsigned int neighbors[4];
+    unsigned int count = 0;
+    if (col > 0 && maze.isPath(cell - 1))
+        neighbors[count++] = cell - 1;
+    if (row + 1 < maze.getRows() && maze.isPath(cell + cols))
+        neighbors[count++] = cell + cols;
+    if (col + 1 < cols && maze.isPath(cell + 1))
+        neighbors[count++] = cell + 1;
+    if (row > 0 && maze.isPath(cell - cols))
+        neighbors[count++] = cell - cols;
+
+    if (collectDeadEnds && count == 1)
+        worker.deadEnds.push_back(cell);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (claim(neighbors[i]))
+            worker.stack.push_back(neighbors[i]);
+    }
+}
+
+bool ParallelDFS::takeShared(Worker & worker)
+{
+    if (worker.sharedSize.load(std::memory_order_relaxed) == 0)
+        return false;
+    std::lock_guard<std::mutex> lock(worker.sharedMutex);
+    if (worker.shared.empty())
+        return false;
+    worker.stack.push_back(worker.shared.back());
+    worker.shared.pop_back();
+    worker.sharedSize.store(worker.shared.size(), std::memory_order_relaxed);
+    return true;
+}
+
+bool ParallelDFS::steal(unsigned int self)
+{
+    Worker& thief = workers[self];
+    for (unsigned int offset = 1; offset < workerCount; ++offset)
+    {
+        Worker& victim = workers[(self + offset) % workerCount];
+        if (victim.sharedSize.load(std::memory_order_relaxed) == 0)
+            continue;
+
+        // Half of what the victim offers, at least one cell
+        std::lock_guard<std::mutex> lock(victim.sharedMutex);
+        size_t take = (victim.shared.size() + 1) / 2;
+        if (take == 0)
+            continue;
+        thief.stack.insert(thief.stack.end(), victim.shared.begin(), victim.shared.begin() + take);
+        victim.shared.erase(victim.shared.begin(), victim.shared.begin() + take);
+        victim.sharedSize.store(victim.shared.size(), std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ParallelDFS::run(const Maze & maze, unsigned int self)
+{
+    Worker& worker = workers[self];
+    bool working = !worker.stack.empty();
+
+    while (true)
+    {
+        while (!worker.stack.empty() || takeShared(worker))
+        {
+            unsigned int cell = worker.stack.back();
+            worker.stack.pop_back();
+            visit(maze, worker, cell);
+
+            // Keep something out for thieves while there is more than the next cell to do
+            if (worker.stack.size() > 1 && worker.sharedSize.load(std::memory_order_relaxed) == 0) {
+                size_t half = worker.stack.size() / 2;
+                std::lock_guard<std::mutex> lock(worker.sharedMutex);
+                worker.shared.insert(worker.shared.end(), worker.stack.begin(), worker.stack.begin() + half);
+                worker.sharedSize.store(worker.shared.size(), std::memory_order_relaxed);
+                worker.stack.erase(worker.stack.begin(), worker.stack.begin() + half);
+            }
+        }
+
+        // Out of work.  Only workers holding work can hand any out, so once active hits 0 nobody ever will again.
+        // A thief counts itself before it looks, so a steal in flight keeps everyone else from quitting
+        if (working) {
+            working = false;
+            active.fetch_sub(1);
+        }
+        active.fetch_add(1);
+        if (steal(self)) {
+            working = true;
+            continue;
+        }
+        if (active.fetch_sub(1) == 1)
+            break;
+        while (active.load() != 0 && !std::any_of(&workers[0], &workers[0] + workerCount, [](const Worker& other) {
+            return other.sharedSize.load(std::memory_order_relaxed) != 0;
+        }))
+            std::this_thread::yield();
+        if (active.load() == 0)
+            break;
+    }
+}
+
+unsigned int ParallelDFS::flood(const Maze & maze, unsigned int start)
+{
+    for (unsigned int i = 0; i < workerCount; ++i)
+        workers[i].count = 0;
+    if (!claim(start))
+        return 0;
+
+    // Small regions never leave the calling thread
+    Worker& first = workers[0];
+    first.stack.push_back(start);
+    for (unsigned int step = 0; step < SERIAL_LIMIT && !first.stack.empty(); ++step)
+    {
+        unsigned int cell = first.stack.back();
+        first.stack.pop_back();
+        visit(maze, first, cell);
+    }
+
+    if (!first.stack.empty()) {
+        if (workerCount == 1) {
+            while (!first.stack.empty())
+            {
+                unsigned int cell = first.stack.back();
+                first.stack.pop_back();
+                visit(maze, first, cell);
+            }
+        }
+        else {
+            active.store(1); // Worker 0, the one holding the stack
+            for (unsigned int self = 0; self < workerCount; ++self)
+            {
+                pool.enqueue([this, &maze, self](unsigned int) {
+                    run(maze, self);
+                });
+            }
+            pool.wait();
+        }
+    }
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < workerCount; ++i)
+        count += workers[i].count;
+    return count;
+}
+
+unsigned int ParallelDFS::countReachable(const Maze & maze, unsigned int start)
+{
+    if (start >= maze.cellCount() || maze.isWall(start))
+        return 0;
+    begin(maze.cellCount());
+    labels = nullptr;
+    collectDeadEnds = false;
+    return flood(maze, start);
+}
+
+void ParallelDFS::deadEnds(const Maze & maze, unsigned int start, std::vector<unsigned int>& cells)
+{
+    cells.clear();
+    if (start >= maze.cellCount() || maze.isWall(start))
+        return;
+    begin(maze.cellCount());
+    labels = nullptr;
+    collectDeadEnds = true;
+    flood(maze, start);
+
+    for (unsigned int i = 0; i < workerCount; ++i)
+        cells.insert(cells.end(), workers[i].deadEnds.begin(), workers[i].deadEnds.end());
+    std::sort(cells.begin(), cells.end());
+}
+
+unsigned int ParallelDFS::labelRegions(const Maze & maze, std::vector<unsigned int>& labels)
+{
+    labels.assign(maze.cellCount(), NO_REGION);
+    begin(maze.cellCount());
+    this->labels = labels.data();
+    collectDeadEnds = false;
+
+    // Cells are seeded in index order, so the first cell seen of every region is its smallest
+    unsigned int regions = 0;
+    for (unsigned int cell = 0; cell < maze.cellCount(); ++cell)
+    {
+        if (maze.isWall(cell) || labels[cell] != NO_REGION)
+            continue;
+        label = cell;
+        flood(maze, cell);
+        ++regions;
+    }
+    this->labels = nullptr;
+    return regions;
+}
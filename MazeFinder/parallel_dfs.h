@@ -0,0 +1,82 @@
+#ifndef PARALLEL_DFS_H
+#define PARALLEL_DFS_H
+
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <climits>
+
+#include "maze.h"
+#include "thread_pool.h"
+
+/*
+    Work stealing DFS for whole region questions: how many cells start reaches, which of them are dead ends,
+    and which region every cell belongs to.  Order doesn't matter for any of them, so the DFS is free to split.
+
+    Each worker pops from a private stack.  When its shared deque is empty it moves the older half of the stack there,
+    and workers that run dry steal from the front of someone else's deque, the oldest entries are the biggest subtrees.
+    A cell is claimed by setting its bit in the shared visited bitmap with fetch_or, so each one is counted once.
+    The first SERIAL_LIMIT cells run on the calling thread, most regions end before the pool is worth waking up.
+
+    Results don't depend on the thread count: dead ends come back sorted and a region's label is its smallest cell.
+*/
+class ParallelDFS
+{
+private:
+    struct Worker
+    {
+        std::vector<unsigned int> stack; // Private, newest at the back
+        std::mutex sharedMutex;
+        std::deque<unsigned int> shared; // Stealable, oldest at the front
+        std::atomic<size_t> sharedSize; // Read without the lock to skip empty victims
+        unsigned int count; // Cells this worker claimed
+        std::vector<unsigned int> deadEnds;
+
+        Worker() : sharedSize(0), count(0) {}
+    };
+
+    ThreadPool& pool;
+    unsigned int workerCount;
+    unsigned int cellCount;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> visited; // Bit per cell
+    std::unique_ptr<Worker[]> workers;
+    std::atomic<unsigned int> active; // Workers holding work, or in the middle of a steal
+
+    // Where the current flood writes
+    unsigned int * labels;
+    unsigned int label;
+    bool collectDeadEnds;
+
+    void begin(unsigned int cellCount);
+    bool claim(unsigned int cell); // True for the one caller that marks cell visited
+    void visit(const Maze& maze, Worker& worker, unsigned int cell); // Claimed cell: record it, push what it leads to
+    bool takeShared(Worker& worker); // Own deque back into the private stack
+    bool steal(unsigned int self);
+    void run(const Maze& maze, unsigned int self);
+    unsigned int flood(const Maze& maze, unsigned int start); // Cells claimed, worker deadEnds hold the dead ends
+
+public:
+    static const unsigned int NO_REGION = UINT_MAX;
+    static const unsigned int SERIAL_LIMIT = 4096; // Cells explored on the calling thread before the pool joins in
+
+    //Constructor
+    explicit ParallelDFS(ThreadPool& pool);
+
+    // Path cells start can reach, start included.  0 when start is a wall
+    unsigned int countReachable(const Maze& maze, unsigned int start);
+
+    // Reachable path cells with exactly one path neighbor, ascending
+    void deadEnds(const Maze& maze, unsigned int start, std::vector<unsigned int>& cells);
+
+    // labels[cell] = smallest cell of cell's region, NO_REGION for walls.  Returns the number of regions
+    unsigned int labelRegions(const Maze& maze, std::vector<unsigned int>& labels);
+
+    // Make it Non Copyable
+    ParallelDFS(const ParallelDFS &) = delete;
+    ParallelDFS &operator= (const ParallelDFS &) = delete;
+};
+
+#endif // !PARALLEL_DFS_H
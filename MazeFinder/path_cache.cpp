@@ -0,0 +1,445 @@
+#include "path_cache.h"
+
+#include "zobrist.h"
+#include "search_context.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+    // Rough per entry overhead: list node, hash map node and bucket, layout member node
+    const std::size_t NODE_OVERHEAD = 96;
+    const std::size_t TILE_OVERHEAD = sizeof(unsigned int) + 32; // Tile id in the entry, set node in the layout
+
+    enum Move { MOVE_LEFT = 0, MOVE_DOWN = 1, MOVE_RIGHT = 2, MOVE_UP = 3 };
+
+    unsigned int absDiff(unsigned int valueOne, unsigned int valueTwo)
+    {
+        return valueOne > valueTwo ? valueOne - valueTwo : valueTwo - valueOne;
+    }
+
+}  // namespace
+
+bool PathCache::Key::operator==(const Key & other) const
+{
+    return layout == other.layout && start == other.start && end == other.end && algo == other.algo;
+}
+
+size_t PathCache::KeyHash::operator()(const Key & key) const
+{
+    unsigned long long cells = (static_cast<unsigned long long>(key.start) << 32) | key.end;
+    unsigned long long layout = static_cast<unsigned long long>(reinterpret_cast<std::uintptr_t>(key.layout));
+    return static_cast<size_t>(zobristMix(layout) ^ zobristMix(cells + static_cast<unsigned int>(key.algo)));
+}
+
+const unsigned int PathCache::TILE;
+
+PathCache::PathCache(std::size_t maxBytes)
+    : maxBytes(maxBytes), usedBytes(0), stats{ 0, 0, 0, 0 }
+{
+}
+
+std::size_t PathCache::entryBytes(const Entry & entry)
+{
+    return sizeof(Entry) + NODE_OVERHEAD + entry.moves.capacity() +
+        (entry.crossingTiles.size() + entry.nearbyTiles.size()) * TILE_OVERHEAD;
+}
+
+void PathCache::encode(const std::vector<unsigned int>& path, unsigned int cols, Entry & entry)
+{
+    entry.cols = cols;
+    entry.moves.assign((path.size() + 2) / 4, 0); // path.size() - 1 moves, rounded up
+    if (path.empty()) {
+        entry.minRow = entry.minCol = entry.maxRow = entry.maxCol = 0;
+        return;
+    }
+
+    entry.minRow = entry.maxRow = path[0] / cols;
+    entry.minCol = entry.maxCol = path[0] % cols;
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+        unsigned int move;
+        if (path[i] + 1 == path[i - 1])
+            move = MOVE_LEFT;
+        else if (path[i] == path[i - 1] + cols)
+            move = MOVE_DOWN;
+        else if (path[i] == path[i - 1] + 1)
+            move = MOVE_RIGHT;
+        else
+            move = MOVE_UP;
+        entry.moves[(i - 1) / 4] |= static_cast<std::uint8_t>(move << (((i - 1) % 4) * 2));
+
+        unsigned int row = path[i] / cols;
+        unsigned int col = path[i] % cols;
+        entry.minRow = std::min(entry.minRow, row);
+        entry.maxRow = std::max(entry.maxRow, row);
+        entry.minCol = std::min(entry.minCol, col);
+        entry.maxCol = std::max(entry.maxCol, col);
+    }
+}
+
+void PathCache::decode(const Entry & entry, std::vector<unsigned int>& path)
+{
+    path.clear();
+    if (!entry.found)
+        return;
+
+    unsigned int cell = entry.key.start;
+    path.reserve(entry.pathLength + 1);
+    path.push_back(cell);
+    for (unsigned int i = 0; i < entry.pathLength; ++i)
+    {
+        switch ((entry.moves[i / 4] >> ((i % 4) * 2)) & 3)
+        {
+        case MOVE_LEFT: cell -= 1; break;
+        case MOVE_DOWN: cell += entry.cols; break;
+        case MOVE_RIGHT: cell += 1; break;
+        default: cell -= entry.cols; break;
+        }
+        path.push_back(cell);
+    }
+}
+
+unsigned int PathCache::tileOf(unsigned int cell, unsigned int cols)
+{
+    return (cell / cols / TILE) * ((cols + TILE - 1) / TILE) + (cell % cols) / TILE;
+}
+
+void PathCache::fileTiles(const std::vector<unsigned int>& path, unsigned int rows, Entry & entry)
+{
+    entry.crossingTiles.clear();
+    entry.nearbyTiles.clear();
+    if (!entry.found)
+        return;
+
+    unsigned int cols = entry.cols;
+    for (unsigned int cell : path)
+        entry.crossingTiles.push_back(tileOf(cell, cols));
+    std::sort(entry.crossingTiles.begin(), entry.crossingTiles.end());
+    entry.crossingTiles.erase(std::unique(entry.crossingTiles.begin(), entry.crossingTiles.end()), entry.crossingTiles.end());
+    entry.crossingTiles.shrink_to_fit();
+    if (entry.key.algo == Algorithm::DFS)
+        return;
+
+    // Tiles holding a cell whose Manhattan detour start -> cell -> end is under pathLength, see stillValid().
+    // Rows and columns add up separately, so each tile's best cell is its closest one to the start / end box
+    unsigned int startRow = entry.key.start / cols, startCol = entry.key.start % cols;
+    unsigned int endRow = entry.key.end / cols, endCol = entry.key.end % cols;
+    unsigned int lowRow = std::min(startRow, endRow), highRow = std::max(startRow, endRow);
+    unsigned int lowCol = std::min(startCol, endCol), highCol = std::max(startCol, endCol);
+    unsigned int slack = (entry.pathLength - (highRow - lowRow) - (highCol - lowCol)) / 2;
+    unsigned int firstTileRow = (lowRow > slack ? lowRow - slack : 0) / TILE;
+    unsigned int lastTileRow = std::min(highRow + slack, rows - 1) / TILE;
+    unsigned int firstTileCol = (lowCol > slack ? lowCol - slack : 0) / TILE;
+    unsigned int lastTileCol = std::min(highCol + slack, cols - 1) / TILE;
+    unsigned int tileCols = (cols + TILE - 1) / TILE;
+    for (unsigned int tileRow = firstTileRow; tileRow <= lastTileRow; ++tileRow)
+    {
+        unsigned int row = std::min(std::max(lowRow, tileRow * TILE), tileRow * TILE + TILE - 1);
+        unsigned int rowDetour = absDiff(startRow, row) + absDiff(row, endRow);
+        for (unsigned int tileCol = firstTileCol; tileCol <= lastTileCol; ++tileCol)
+        {
+            unsigned int col = std::min(std::max(lowCol, tileCol * TILE), tileCol * TILE + TILE - 1);
+            if (rowDetour + absDiff(startCol, col) + absDiff(col, endCol) < entry.pathLength)
+                entry.nearbyTiles.push_back(tileRow * tileCols + tileCol);
+        }
+    }
+    entry.nearbyTiles.shrink_to_fit();
+}
+
+bool PathCache::crosses(const Entry & entry, unsigned int cell)
+{
+    if (!entry.found)
+        return false;
+
+    unsigned int row = cell / entry.cols;
+    unsigned int col = cell % entry.cols;
+    if (row < entry.minRow || row > entry.maxRow || col < entry.minCol || col > entry.maxCol)
+        return false;
+
+    // Walk the moves without building the path
+    unsigned int current = entry.key.start;
+    if (current == cell)
+        return true;
+    for (unsigned int i = 0; i < entry.pathLength; ++i)
+    {
+        switch ((entry.moves[i / 4] >> ((i % 4) * 2)) & 3)
+        {
+        case MOVE_LEFT: current -= 1; break;
+        case MOVE_DOWN: current += entry.cols; break;
+        case MOVE_RIGHT: current += 1; break;
+        default: current -= entry.cols; break;
+        }
+        if (current == cell)
+            return true;
+    }
+    return false;
+}
+
+bool PathCache::stillValid(const Entry & entry, unsigned int cell, bool wall)
+{
+    // A new wall can only break paths that go through it.  No path stays no path
+    if (wall)
+        return !crosses(entry, cell);
+
+    // An opened cell can connect anything, and DFS would walk somewhere else
+    if (!entry.found || entry.key.algo == Algorithm::DFS)
+        return false;
+
+    // Any path through the opened cell is at least as long as the Manhattan detour through it
+    unsigned int cols = entry.cols;
+    unsigned int cellRow = cell / cols, cellCol = cell % cols;
+    unsigned int detour = absDiff(entry.key.start / cols, cellRow) + absDiff(entry.key.start % cols, cellCol) +
+        absDiff(cellRow, entry.key.end / cols) + absDiff(cellCol, entry.key.end % cols);
+    return detour >= entry.pathLength;
+}
+
+void PathCache::link(Entry & entry)
+{
+    Layout& layout = *entry.key.layout;
+    layout.members.insert(&entry);
+    for (unsigned int tile : entry.crossingTiles)
+        layout.crossing[tile].insert(&entry);
+    for (unsigned int tile : entry.nearbyTiles)
+        layout.nearby[tile].insert(&entry);
+    if (!entry.found || entry.key.algo == Algorithm::DFS)
+        layout.dropOnOpen.insert(&entry);
+}
+
+void PathCache::unlink(Entry & entry)
+{
+    Layout& layout = *entry.key.layout;
+    layout.members.erase(&entry);
+    for (unsigned int tile : entry.crossingTiles)
+    {
+        auto bucket = layout.crossing.find(tile);
+        bucket->second.erase(&entry);
+        if (bucket->second.empty())
+            layout.crossing.erase(bucket);
+    }
+    for (unsigned int tile : entry.nearbyTiles)
+    {
+        auto bucket = layout.nearby.find(tile);
+        bucket->second.erase(&entry);
+        if (bucket->second.empty())
+            layout.nearby.erase(bucket);
+    }
+    layout.dropOnOpen.erase(&entry);
+}
+
+void PathCache::erase(EntryList::iterator it)
+{
+    Layout * layout = it->key.layout;
+    unlink(*it);
+    usedBytes -= entryBytes(*it);
+    index.erase(it->key);
+    entries.erase(it);
+    dropIfEmpty(layout);
+}
+
+void PathCache::erase(Entry * entry)
+{
+    erase(index.find(entry->key)->second);
+}
+
+void PathCache::dropIfEmpty(Layout * layout)
+{
+    if (!layout->members.empty())
+        return;
+    auto it = layouts.find(layout->hash);
+    if (it != layouts.end() && it->second.get() == layout)
+        layouts.erase(it);
+}
+
+void PathCache::evictToFit()
+{
+    while (usedBytes > maxBytes && !entries.empty())
+    {
+        erase(std::prev(entries.end()));
+        ++stats.evictions;
+    }
+}
+
+bool PathCache::lookup(unsigned long long mazeHash, Algorithm algo, unsigned int start, unsigned int end,
+    SolveResult & result, std::vector<unsigned int>* path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto layout = layouts.find(mazeHash);
+    auto found = layout == layouts.end() ? index.end() : index.find(Key{ layout->second.get(), start, end, algo });
+    if (found == index.end()) {
+        ++stats.misses;
+        return false;
+    }
+
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, found->second);
+    const Entry& entry = *found->second;
+    result.found = entry.found;
+    result.pathLength = entry.pathLength;
+    result.expanded = entry.expanded;
+    if (path)
+        decode(entry, *path);
+    return true;
+}
+
+void PathCache::insert(unsigned long long mazeHash, unsigned int rows, unsigned int cols, Algorithm algo, unsigned int start, unsigned int end,
+    const SolveResult & result, const std::vector<unsigned int>& path)
+{
+    // A found result without its path can't be checked against later edits
+    if (result.found && path.size() != result.pathLength + 1)
+        return;
+
+    Entry entry;
+    entry.key = Key{ nullptr, start, end, algo };
+    entry.found = result.found;
+    entry.pathLength = result.found ? result.pathLength : 0;
+    entry.expanded = result.expanded;
+    encode(result.found ? path : std::vector<unsigned int>(), cols, entry);
+    fileTiles(path, rows, entry);
+    if (entryBytes(entry) > maxBytes)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<Layout>& layout = layouts[mazeHash];
+    if (!layout) {
+        layout.reset(new Layout());
+        layout->hash = mazeHash;
+        layout->rows = rows;
+        layout->cols = cols;
+    }
+    entry.key.layout = layout.get();
+
+    // Replacing the layout's last entry would drop the layout, so the new one goes in first
+    auto existing = index.find(entry.key);
+    EntryList::iterator old = existing != index.end() ? existing->second : entries.end();
+
+    usedBytes += entryBytes(entry);
+    entries.push_front(std::move(entry));
+    if (old != entries.end()) {
+        unlink(*old);
+        usedBytes -= entryBytes(*old);
+        entries.erase(old);
+    }
+    index[entries.front().key] = entries.begin();
+    link(entries.front());
+    evictToFit();
+}
+
+void PathCache::wallChanged(unsigned long long oldHash, unsigned long long newHash, unsigned int cell, bool wall)
+{
+    if (oldHash == newHash)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto oldLayout = layouts.find(oldHash);
+    if (oldLayout == layouts.end())
+        return;
+
+    // Only entries filed under the cell's tile can change, collected first since erase() edits the sets
+    Layout * layout = oldLayout->second.get();
+    std::vector<Entry*> stale;
+    TileIndex& tiles = wall ? layout->crossing : layout->nearby;
+    auto bucket = tiles.find(tileOf(cell, layout->cols));
+    if (bucket != tiles.end()) {
+        for (Entry * entry : bucket->second)
+            if (!stillValid(*entry, cell, wall))
+                stale.push_back(entry);
+    }
+    if (!wall)
+        stale.insert(stale.end(), layout->dropOnOpen.begin(), layout->dropOnOpen.end());
+    std::sort(stale.begin(), stale.end());
+    stale.erase(std::unique(stale.begin(), stale.end()), stale.end());
+    stats.invalidations += stale.size();
+    for (Entry * entry : stale)
+        erase(entry);
+
+    // The rest moves over with its layout.  LRU positions stay the same
+    oldLayout = layouts.find(oldHash);
+    if (oldLayout == layouts.end())
+        return;
+    std::unique_ptr<Layout> moved = std::move(oldLayout->second);
+    layouts.erase(oldLayout);
+    moved->hash = newHash;
+    std::unique_ptr<Layout>& target = layouts[newHash];
+    if (!target) {
+        target = std::move(moved);
+        return;
+    }
+
+    // Something was already cached for the new layout.  Fold the smaller one into the bigger one,
+    // and where both solved the same query keep the one that was already there
+    bool keepMoved = moved->members.size() > target->members.size();
+    if (keepMoved)
+        std::swap(moved, target);
+    Layout * into = target.get();
+    std::vector<Entry*> folding(moved->members.begin(), moved->members.end());
+    for (Entry * entry : folding)
+    {
+        EntryList::iterator it = index.find(entry->key)->second;
+        unlink(*entry);
+        index.erase(entry->key);
+        entry->key.layout = into;
+        auto clash = index.find(entry->key);
+        if (clash != index.end() && !keepMoved) {
+            usedBytes -= entryBytes(*entry);
+            entries.erase(it);
+            continue;
+        }
+        if (clash != index.end()) {
+            // The one being folded in was solved on this layout already, it wins
+            EntryList::iterator other = clash->second;
+            unlink(*other);
+            usedBytes -= entryBytes(*other);
+            index.erase(clash);
+            entries.erase(other);
+        }
+        index[entry->key] = it;
+        link(*entry);
+    }
+}
+
+void PathCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    layouts.clear();
+    usedBytes = 0;
+}
+
+std::size_t PathCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+std::size_t PathCache::bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+PathCacheStats PathCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+SolveResult solveCached(PathCache * cache, const Maze & maze, SearchContext & context, Algorithm algo, unsigned int start, unsigned int end,
+    std::vector<unsigned int>* path)
+{
+    if (!cache)
+        return solve(maze, context, algo, start, end, path);
+
+    SolveResult result;
+    if (cache->lookup(maze.getHash(), algo, start, end, result, path))
+        return result;
+
+    std::vector<unsigned int> solvedPath;
+    result = solve(maze, context, algo, start, end, &solvedPath);
+    cache->insert(maze.getHash(), maze.getRows(), maze.getCols(), algo, start, end, result, solvedPath);
+    if (path)
+        path->swap(solvedPath);
+    return result;
+}
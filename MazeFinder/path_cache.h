@@ -0,0 +1,139 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+#include "solver.h"
+
+/*
+    LRU cache of solve results, keyed by (maze hash, algorithm, start, end).
+    The maze hash is the incremental Zobrist hash from Maze::getHash() / Graph, so identical mazes share entries.
+
+    Paths are stored as the start cell plus 2 bits per move, and bytes() counts them against maxBytes.
+    A wall edit only drops the entries it can change, everything else is moved over to the new hash:
+        wall added      entries whose path crosses the cell
+        wall removed    BFS / A* entries the new cell could shorten (Manhattan bound through it),
+                        every "not found" entry and every DFS entry
+    The bound assumes the stored path is a shortest one, so only optimal solvers should insert BFS / A* results.
+
+    Entries hang off the Layout of their maze hash.  An edit renames the Layout to the new hash, so entries
+    that stay cost nothing, and each Layout indexes its entries by TILE x TILE tiles: the tiles a path
+    crosses and the tiles holding a cell that could shorten it.  wallChanged() only looks at the entries
+    filed under the edited cell's tile, plus the ones any opened cell drops.
+    Thread safe, one mutex around everything.
+*/
+
+struct PathCacheStats
+{
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long evictions; // Dropped for the memory cap
+    unsigned long long invalidations; // Dropped by wallChanged()
+};
+
+class PathCache
+{
+private:
+    struct Layout;
+    struct Entry;
+    typedef std::unordered_set<Entry*> EntrySet;
+    typedef std::unordered_map<unsigned int, EntrySet> TileIndex; // Tile id -> entries filed there
+
+    struct Key
+    {
+        Layout * layout;
+        unsigned int start;
+        unsigned int end;
+        Algorithm algo;
+
+        bool operator== (const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        size_t operator() (const Key& key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        bool found;
+        unsigned int pathLength;
+        unsigned int expanded;
+        unsigned int cols; // Needed to decode the moves
+        unsigned int minRow, minCol, maxRow, maxCol; // Bounding box of the path, cheap reject for crosses()
+        std::vector<std::uint8_t> moves; // 2 bits per move, 4 per byte
+        std::vector<unsigned int> crossingTiles; // Tiles the path goes through
+        std::vector<unsigned int> nearbyTiles; // Tiles with a cell that, once opened, could beat pathLength
+    };
+
+    // Every entry cached for one wall layout
+    struct Layout
+    {
+        unsigned long long hash;
+        unsigned int rows;
+        unsigned int cols;
+        EntrySet members;
+        TileIndex crossing; // A new wall in the tile can break these
+        TileIndex nearby; // An opened cell in the tile can shorten these
+        EntrySet dropOnOpen; // "Not found" and DFS entries, any opened cell can change them
+    };
+
+    typedef std::list<Entry> EntryList; // Most recently used first
+
+    static const unsigned int TILE = 16;
+
+    std::size_t maxBytes;
+    std::size_t usedBytes;
+    EntryList entries;
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index;
+    std::unordered_map<unsigned long long, std::unique_ptr<Layout>> layouts; // By maze hash
+    PathCacheStats stats;
+    mutable std::mutex mutex;
+
+    static std::size_t entryBytes(const Entry& entry);
+    static void encode(const std::vector<unsigned int>& path, unsigned int cols, Entry& entry);
+    static void decode(const Entry& entry, std::vector<unsigned int>& path);
+    static void fileTiles(const std::vector<unsigned int>& path, unsigned int rows, Entry& entry);
+    static unsigned int tileOf(unsigned int cell, unsigned int cols);
+    static bool crosses(const Entry& entry, unsigned int cell);
+    static bool stillValid(const Entry& entry, unsigned int cell, bool wall);
+
+    void link(Entry& entry); // Files it under key.layout
+    void unlink(Entry& entry);
+    void erase(EntryList::iterator it);
+    void erase(Entry * entry);
+    void dropIfEmpty(Layout * layout);
+    void evictToFit();
+
+public:
+    explicit PathCache(std::size_t maxBytes);
+
+    // True on a hit.  path is filled (start..end inclusive) when it's not null and the entry was found
+    bool lookup(unsigned long long mazeHash, Algorithm algo, unsigned int start, unsigned int end,
+        SolveResult& result, std::vector<unsigned int> * path = nullptr);
+
+    // path is what solve() wrote, it may be empty when result.found is false
+    void insert(unsigned long long mazeHash, unsigned int rows, unsigned int cols, Algorithm algo, unsigned int start, unsigned int end,
+        const SolveResult& result, const std::vector<unsigned int>& path);
+
+    // Call after every wall edit with the hash before and after it
+    void wallChanged(unsigned long long oldHash, unsigned long long newHash, unsigned int cell, bool wall);
+
+    void clear();
+    std::size_t size() const;
+    std::size_t bytes() const;
+    PathCacheStats getStats() const;
+};
+
+// Looks the query up in cache and solves on a miss with context.  cache may be null
+SolveResult solveCached(PathCache * cache, const Maze& maze, SearchContext& context, Algorithm algo, unsigned int start, unsigned int end,
+    std::vector<unsigned int> * path = nullptr);
+
+#endif // !PATH_CACHE_H
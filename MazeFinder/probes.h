@@ -0,0 +1,51 @@
+#ifndef PROBES_H
+#define PROBES_H
+
+/*
+    Static tracepoints (USDT / SystemTap SDT notes) for perf and bpftrace.
+
+    On Linux, when <sys/sdt.h> is available (systemtap-sdt-dev / systemtap-sdt-devel),
+    every probe compiles to a single nop plus an ELF note.  Nothing runs until a tracer attaches.
+    Everywhere else (MSVC, or MAZEFINDER_NO_USDT defined) they expand to nothing.
+
+    List:    perf list sdt_mazefinder:*     or   bpftrace -l 'usdt:./MazeFinder:*'
+    Example: bpftrace -e 'usdt:./MazeFinder:mazefinder:solve__start { @t[tid] = nsecs; }
+                          usdt:./MazeFinder:mazefinder:solve__end /@t[tid]/ { @ns = hist(nsecs - @t[tid]); }'
+
+    Probes (provider "mazefinder"):
+    - solve__start      (algo, startRow, startCol)
+    - solve__end        (algo, found, pathLength)
+    - node__expand      (row, col)
+    - heap__insert      (heapSize)
+    - heap__extract     (heapSize)
+    - maze__subdivide   (topRow, leftCol, botRow, rightCol)
+    - frame__render     (frameNumber)
+*/
+
+// Algorithm ids passed to solve__start / solve__end
+#define MAZE_PROBE_ALGO_BFS 0
+#define MAZE_PROBE_ALGO_DFS 1
+#define MAZE_PROBE_ALGO_ASTAR 2
+#define MAZE_PROBE_ALGO_DSTAR_LITE 3
+#define MAZE_PROBE_ALGO_FLOW_FIELD 4
+
+#if defined(__linux__) && !defined(MAZEFINDER_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define MAZEFINDER_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef MAZEFINDER_HAVE_USDT
+#include <sys/sdt.h>
+#define MAZE_PROBE1(name, a) DTRACE_PROBE1(mazefinder, name, a)
+#define MAZE_PROBE2(name, a, b) DTRACE_PROBE2(mazefinder, name, a, b)
+#define MAZE_PROBE3(name, a, b, c) DTRACE_PROBE3(mazefinder, name, a, b, c)
+#define MAZE_PROBE4(name, a, b, c, d) DTRACE_PROBE4(mazefinder, name, a, b, c, d)
+#else
+#define MAZE_PROBE1(name, a) do {} while (0)
+#define MAZE_PROBE2(name, a, b) do {} while (0)
+#define MAZE_PROBE3(name, a, b, c) do {} while (0)
+#define MAZE_PROBE4(name, a, b, c, d) do {} while (0)
+#endif
+
+#endif // !PROBES_H
@@ -0,0 +1,41 @@
+#include "search_context.h"
+
+#include <algorithm>
+
+SearchContext::SearchContext()
+    : cellCount(0), epoch(0)
+{
+}
+
+void SearchContext::clearStamps()
+{
+    std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+    std::fill(touchedStamp.begin(), touchedStamp.end(), 0);
+}
+
+void SearchContext::begin(unsigned int cellCount)
+{
+    if (this->cellCount != cellCount) {
+        this->cellCount = cellCount;
+        visitedStamp.assign(cellCount, 0);
+        touchedStamp.assign(cellCount, 0);
+        distance.resize(cellCount);
+        parent.resize(cellCount);
+        epoch = 0;
+
+        // BFS and DFS push a cell at most once, so solves never grow the frontier mid search.
+        // A* can push a cell again when it finds a cheaper way in, the heap just grows once and keeps it
+        frontier.reserve(cellCount);
+        nextNeighbor.reserve(cellCount);
+        open.reserve(cellCount);
+    }
+
+    // Stamps from 4 billion searches ago would look current again, so wipe them once per wraparound
+    if (++epoch == 0) {
+        clearStamps();
+        epoch = 1;
+    }
+    frontier.clear();
+    nextNeighbor.clear();
+    open.clear();
+}
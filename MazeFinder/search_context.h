@@ -0,0 +1,66 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <vector>
+#include <climits>
+
+#include "solver.h"
+
+/*
+    Per-query scratch for BFS / DFS / A*: visited flags, distances (BFS depth or A* g cost),
+    parents, plus the frontier containers.  The maze itself is never written during a search,
+    so any number of threads can solve on one Maze at once as long as each has its own context.
+
+    Reuse a context across queries.  Every cell carries the epoch (search number) it was last written in,
+    and anything stamped with an older epoch reads as unvisited / UNREACHED / NO_PARENT.  So begin() is O(1),
+    the arrays are only wiped when the 32-bit epoch wraps around or the maze size changes.
+*/
+class SearchContext
+{
+private:
+    unsigned int cellCount;
+    unsigned int epoch; // Current search, never 0 after begin()
+    std::vector<unsigned int> visitedStamp; // == epoch means visited
+    std::vector<unsigned int> touchedStamp; // == epoch means distance / parent were written this search
+    std::vector<unsigned int> distance;
+    std::vector<unsigned int> parent;
+
+    // First write of a cell this search, reset the other field so it can't leak from an older search
+    void touch(unsigned int cell)
+    {
+        if (touchedStamp[cell] != epoch) {
+            touchedStamp[cell] = epoch;
+            distance[cell] = UNREACHED;
+            parent[cell] = NO_PARENT;
+        }
+    }
+
+    void clearStamps();
+
+public:
+    static const unsigned int UNREACHED = UINT_MAX;
+    static const unsigned int NO_PARENT = UINT_MAX;
+
+    // Frontiers.  Left with whatever the last search put in them, begin() empties them
+    std::vector<unsigned int> frontier; // BFS queue (read from a head index) or DFS stack
+    std::vector<unsigned char> nextNeighbor; // DFS: per stack entry, the neighbor it tries next
+    MinHeap open; // A* open list
+
+    //Constructor
+    SearchContext();
+
+    void begin(unsigned int cellCount); // Start a new search on a maze of cellCount cells.  O(1) unless the size changed
+    unsigned int size() const { return cellCount; }
+    unsigned int getEpoch() const { return epoch; }
+
+    bool isVisited(unsigned int cell) const { return visitedStamp[cell] == epoch; }
+    void setVisited(unsigned int cell) { visitedStamp[cell] = epoch; }
+
+    unsigned int getDistance(unsigned int cell) const { return touchedStamp[cell] == epoch ? distance[cell] : UNREACHED; }
+    void setDistance(unsigned int cell, unsigned int value) { touch(cell); distance[cell] = value; }
+
+    unsigned int getParent(unsigned int cell) const { return touchedStamp[cell] == epoch ? parent[cell] : NO_PARENT; }
+    void setParent(unsigned int cell, unsigned int value) { touch(cell); parent[cell] = value; }
+};
+
+#endif // !SEARCH_CONTEXT_H
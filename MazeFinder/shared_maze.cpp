@@ -0,0 +1,365 @@
+#include "shared_maze.h"
+#include "search_context.h"
+
+#include <cstring>
+#include <thread>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+    const std::uint64_t DATA_ALIGN = 64;
+    const unsigned int MAX_SOLVE_RETRIES = 64;
+
+    std::uint64_t dataOffset()
+    {
+        return (sizeof(SharedMazeHeader) + DATA_ALIGN - 1) / DATA_ALIGN * DATA_ALIGN;
+    }
+
+#ifdef _WIN32
+    std::string osName(const std::string& name)
+    {
+        return "Local\\mazefinder_" + name;
+    }
+#else
+    std::string osName(const std::string& name)
+    {
+        return "/mazefinder_" + name;
+    }
+#endif
+
+}  // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+// SharedMemoryRegion
+
+#ifdef _WIN32
+
+SharedMemoryRegion::SharedMemoryRegion()
+    : address(nullptr), size(0), mapping(nullptr)
+{
+}
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    close();
+}
+
+bool SharedMemoryRegion::create(const std::string & name, std::size_t size, std::string & error)
+{
+    close();
+    std::string fullName = osName(name);
+    unsigned long long size64 = size;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xffffffffULL), fullName.c_str());
+    if (handle == nullptr) {
+        error = "CreateFileMapping failed for " + fullName;
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(handle);
+        error = fullName + " is already published";
+        return false;
+    }
+
+    void * view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(handle);
+        error = "MapViewOfFile failed for " + fullName;
+        return false;
+    }
+    mapping = handle;
+    address = view;
+    this->size = size;
+    this->name = fullName;
+    return true;
+}
+
+bool SharedMemoryRegion::open(const std::string & name, std::string & error)
+{
+    close();
+    std::string fullName = osName(name);
+    HANDLE handle = OpenFileMappingA(FILE_MAP_READ, FALSE, fullName.c_str());
+    if (handle == nullptr) {
+        error = fullName + " is not published";
+        return false;
+    }
+
+    void * view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (view == nullptr || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view)
+            UnmapViewOfFile(view);
+        CloseHandle(handle);
+        error = "MapViewOfFile failed for " + fullName;
+        return false;
+    }
+    mapping = handle;
+    address = view;
+    size = info.RegionSize;
+    this->name = fullName;
+    return true;
+}
+
+void SharedMemoryRegion::close()
+{
+    // The mapping disappears with its last handle, there is nothing to unlink on Windows
+    if (address)
+        UnmapViewOfFile(address);
+    if (mapping)
+        CloseHandle(mapping);
+    address = nullptr;
+    mapping = nullptr;
+    size = 0;
+    name.clear();
+}
+
+#else
+
+SharedMemoryRegion::SharedMemoryRegion()
+    : address(nullptr), size(0), fd(-1), owner(false)
+{
+}
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    close();
+}
+
+bool SharedMemoryRegion::create(const std::string & name, std::size_t size, std::string & error)
+{
+    close();
+    std::string fullName = osName(name);
+    int handle = shm_open(fullName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (handle < 0) {
+        error = "shm_open " + fullName + ": " + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(handle, static_cast<off_t>(size)) != 0) {
+        error = "ftruncate " + fullName + ": " + std::strerror(errno);
+        ::close(handle);
+        shm_unlink(fullName.c_str());
+        return false;
+    }
+
+    void * view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        error = "mmap " + fullName + ": " + std::strerror(errno);
+        ::close(handle);
+        shm_unlink(fullName.c_str());
+        return false;
+    }
+    fd = handle;
+    address = view;
+    this->size = size;
+    this->name = fullName;
+    owner = true;
+    return true;
+}
+
+bool SharedMemoryRegion::open(const std::string & name, std::string & error)
+{
+    close();
+    std::string fullName = osName(name);
+    int handle = shm_open(fullName.c_str(), O_RDONLY, 0);
+    if (handle < 0) {
+        error = "shm_open " + fullName + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(handle, &info) != 0 || info.st_size <= 0) {
+        error = fullName + " has no size yet";
+        ::close(handle);
+        return false;
+    }
+
+    std::size_t length = static_cast<std::size_t>(info.st_size);
+    void * view = mmap(nullptr, length, PROT_READ, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        error = "mmap " + fullName + ": " + std::strerror(errno);
+        ::close(handle);
+        return false;
+    }
+    fd = handle;
+    address = view;
+    size = length;
+    this->name = fullName;
+    owner = false;
+    return true;
+}
+
+void SharedMemoryRegion::close()
+{
+    // Unlinking only removes the name, readers that already mapped it keep working
+    if (address)
+        munmap(address, size);
+    if (fd >= 0)
+        ::close(fd);
+    if (owner)
+        shm_unlink(name.c_str());
+    address = nullptr;
+    size = 0;
+    fd = -1;
+    owner = false;
+    name.clear();
+}
+
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// SharedMazePublisher
+
+SharedMazePublisher::SharedMazePublisher()
+    : header(nullptr), cells(nullptr)
+{
+}
+
+bool SharedMazePublisher::publish(const std::string & name, const Maze & maze, std::string & error)
+{
+    unpublish();
+    std::uint64_t offset = dataOffset();
+    std::uint64_t dataSize = maze.cellCount();
+    if (!region.create(name, static_cast<std::size_t>(offset + dataSize), error))
+        return false;
+
+    unsigned char * base = static_cast<unsigned char *>(region.getAddress());
+    cells = base + offset;
+    if (dataSize)
+        std::memcpy(cells, maze.data(), static_cast<std::size_t>(dataSize));
+
+    // Fresh pages are zeroed, so a reader that attaches early sees magic == 0 and gives up
+    header = new (base) SharedMazeHeader;
+    header->version = SharedMazeHeader::VERSION;
+    header->rows = maze.getRows();
+    header->cols = maze.getCols();
+    header->dataOffset = offset;
+    header->dataSize = dataSize;
+    header->sequence.store(0, std::memory_order_relaxed);
+    header->generation.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SharedMazeHeader::MAGIC;
+    return true;
+}
+
+void SharedMazePublisher::setWall(unsigned int row, unsigned int col, bool wall)
+{
+    if (!header || row >= header->rows || col >= header->cols)
+        return;
+
+    std::uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    cells[row * header->cols + col] = wall ? 1 : 0;
+    header->generation.fetch_add(1, std::memory_order_relaxed);
+    header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SharedMazePublisher::update(const Maze & maze)
+{
+    if (!header || maze.getRows() != header->rows || maze.getCols() != header->cols)
+        return;
+
+    std::uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(cells, maze.data(), static_cast<std::size_t>(header->dataSize));
+    header->generation.fetch_add(1, std::memory_order_relaxed);
+    header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SharedMazePublisher::unpublish()
+{
+    region.close();
+    header = nullptr;
+    cells = nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// SharedMazeReader
+
+SharedMazeReader::SharedMazeReader()
+    : header(nullptr)
+{
+}
+
+bool SharedMazeReader::attach(const std::string & name, std::string & error)
+{
+    header = nullptr;
+    maze = Maze();
+    if (!region.open(name, error))
+        return false;
+
+    if (region.getSize() < sizeof(SharedMazeHeader)) {
+        error = "Shared maze " + name + " is too small";
+        region.close();
+        return false;
+    }
+
+    const SharedMazeHeader * mapped = static_cast<const SharedMazeHeader *>(region.getAddress());
+    if (mapped->magic != SharedMazeHeader::MAGIC) {
+        error = "Shared maze " + name + " is not a maze, or is still being published";
+        region.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint64_t cellCount = static_cast<std::uint64_t>(mapped->rows) * mapped->cols;
+    if (mapped->version != SharedMazeHeader::VERSION || mapped->dataSize != cellCount
+        || mapped->dataOffset + mapped->dataSize > region.getSize()) {
+        error = "Shared maze " + name + " has an unsupported layout";
+        region.close();
+        return false;
+    }
+
+    header = mapped;
+    const unsigned char * base = static_cast<const unsigned char *>(region.getAddress());
+    maze = Maze::view(mapped->rows, mapped->cols, base + mapped->dataOffset);
+    return true;
+}
+
+std::uint32_t SharedMazeReader::beginRead() const
+{
+    std::uint32_t sequence = header->sequence.load(std::memory_order_acquire);
+    while (sequence & 1)
+    {
+        std::this_thread::yield();
+        sequence = header->sequence.load(std::memory_order_acquire);
+    }
+    return sequence;
+}
+
+bool SharedMazeReader::validate(std::uint32_t sequence) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return header->sequence.load(std::memory_order_relaxed) == sequence;
+}
+
+bool SharedMazeReader::solveConsistent(SearchContext & context, Algorithm algo, unsigned int start, unsigned int end, SolveResult & result) const
+{
+    SolveResult notFound = { false, 0, 0 };
+    result = notFound;
+    if (!header)
+        return false;
+
+    // An edit during the solve can give a torn answer, so solve again.  A publisher that never stops
+    // editing gets a false rather than a reader that spins forever
+    for (unsigned int attempt = 0; attempt < MAX_SOLVE_RETRIES; ++attempt)
+    {
+        std::uint32_t sequence = beginRead();
+        result = solve(maze, context, algo, start, end);
+        if (validate(sequence))
+            return true;
+    }
+    return false;
+}
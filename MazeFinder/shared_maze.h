@@ -0,0 +1,109 @@
+#ifndef SHARED_MAZE_H
+#define SHARED_MAZE_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+#include "maze.h"
+#include "solver.h"
+
+/*
+    Publishes a maze's cells in a named shared memory segment so several processes solve on one copy.
+    POSIX shm_open / mmap on Linux, CreateFileMapping / MapViewOfFile on Windows.
+
+    mazefinder publish --name NAME [--size N --seed S | --load maze.txt]     (keeps it published until Ctrl+C)
+    mazefinder solve --shm NAME ...                                          (solves on the mapped cells)
+
+    Layout: SharedMazeHeader, then rows * cols bytes (1 = wall) at dataOffset.
+    Edits go through a seqlock.  sequence is odd while the publisher is writing, and generation counts
+    finished edits.  Readers map the segment read only and retry a solve when sequence moved under them.
+*/
+
+struct SharedMazeHeader
+{
+    static const std::uint32_t MAGIC = 0x4d5a5348; // "MZSH"
+    static const std::uint32_t VERSION = 1;
+
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint64_t dataOffset;
+    std::uint64_t dataSize;
+    std::atomic<std::uint32_t> sequence; // Seqlock, odd while an edit is in progress
+    std::atomic<std::uint32_t> generation; // Completed edits since publish
+};
+
+// Small OS handle wrapper shared by the publisher and the readers
+class SharedMemoryRegion
+{
+private:
+    void * address;
+    std::size_t size;
+    std::string name;
+#ifdef _WIN32
+    void * mapping;
+#else
+    int fd;
+    bool owner; // Publisher unlinks the name on close
+#endif
+
+public:
+    SharedMemoryRegion();
+    ~SharedMemoryRegion();
+
+    bool create(const std::string& name, std::size_t size, std::string& error);
+    bool open(const std::string& name, std::string& error); // Read only
+    void close();
+
+    void * getAddress() const { return address; }
+    std::size_t getSize() const { return size; }
+
+    // Make it Non Copyable
+    SharedMemoryRegion(const SharedMemoryRegion &) = delete;
+    SharedMemoryRegion &operator= (const SharedMemoryRegion &) = delete;
+};
+
+class SharedMazePublisher
+{
+private:
+    SharedMemoryRegion region;
+    SharedMazeHeader * header;
+    unsigned char * cells;
+
+public:
+    SharedMazePublisher();
+
+    bool publish(const std::string& name, const Maze& maze, std::string& error);
+    void setWall(unsigned int row, unsigned int col, bool wall); // One seqlock protected edit
+    void update(const Maze& maze); // Replaces every cell, same size only
+    void unpublish();
+
+    const SharedMazeHeader * getHeader() const { return header; }
+};
+
+class SharedMazeReader
+{
+private:
+    SharedMemoryRegion region;
+    const SharedMazeHeader * header;
+    Maze maze; // View over the mapped cells
+
+public:
+    SharedMazeReader();
+
+    bool attach(const std::string& name, std::string& error);
+    const Maze& getMaze() const { return maze; }
+    std::uint32_t getGeneration() const { return header->generation.load(std::memory_order_acquire); }
+
+    // Seqlock read side.  beginRead() waits out an edit in progress, validate() says nothing changed since
+    std::uint32_t beginRead() const;
+    bool validate(std::uint32_t sequence) const;
+
+    // Solves on the mapped cells, retrying while the publisher edits underneath.  False when every attempt raced
+    // an edit: result is then the last attempt, which may mix two layouts, so don't report it as an answer
+    bool solveConsistent(SearchContext& context, Algorithm algo, unsigned int start, unsigned int end, SolveResult& result) const;
+};
+
+#endif // !SHARED_MAZE_H
@@ -0,0 +1,166 @@
+#include "solve_client.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+
+bool SolveClient::connect(const std::string & host, unsigned short port, std::string & error)
+{
+    if (socket.connect(sf::IpAddress(host), port, sf::seconds(5)) != sf::Socket::Done) {
+        error = "Could not connect to " + host + ":" + std::to_string(port);
+        return false;
+    }
+    return true;
+}
+
+bool SolveClient::mazeInfo(std::vector<std::pair<unsigned int, unsigned int>>& sizes, std::string & error)
+{
+    sf::Packet request;
+    request << static_cast<sf::Uint8>(SolveProtocol::MAZE_INFO);
+    if (socket.send(request) != sf::Socket::Done) {
+        error = "Send failed";
+        return false;
+    }
+
+    sf::Packet reply;
+    sf::Uint8 type = 0;
+    sf::Uint32 count = 0;
+    if (socket.receive(reply) != sf::Socket::Done || !(reply >> type >> count) || type != SolveProtocol::MAZE_INFO) {
+        error = "Bad MAZE_INFO reply";
+        return false;
+    }
+
+    sizes.clear();
+    for (sf::Uint32 i = 0; i < count; ++i)
+    {
+        sf::Uint32 rows = 0;
+        sf::Uint32 cols = 0;
+        if (!(reply >> rows >> cols)) {
+            error = "Truncated MAZE_INFO reply";
+            return false;
+        }
+        sizes.push_back({ rows, cols });
+    }
+    return true;
+}
+
+bool SolveClient::sendBatch(const std::vector<SolveProtocol::Request>& requests, std::string & error)
+{
+    sf::Packet packet;
+    packet << static_cast<sf::Uint8>(SolveProtocol::SOLVE_BATCH) << static_cast<sf::Uint32>(requests.size());
+    for (const SolveProtocol::Request& request : requests)
+        packet << request;
+
+    if (socket.send(packet) != sf::Socket::Done) {
+        error = "Send failed";
+        return false;
+    }
+    return true;
+}
+
+bool SolveClient::receiveBatch(std::vector<SolveProtocol::Reply>& replies, sf::Uint32 & rejectedId, std::string & error)
+{
+    rejectedId = SolveProtocol::NO_REQUEST_ID;
+    replies.clear();
+    sf::Packet packet;
+    if (socket.receive(packet) != sf::Socket::Done) {
+        error = "Connection lost";
+        return false;
+    }
+
+    sf::Uint8 type = 0;
+    packet >> type;
+    if (type == SolveProtocol::ERROR_REPLY) {
+        std::string message;
+        packet >> rejectedId >> message;
+        error = "Server error: " + message;
+        return packet && rejectedId != SolveProtocol::NO_REQUEST_ID; // Without an id there's no telling which batch it was
+    }
+
+    sf::Uint32 count = 0;
+    if (type != SolveProtocol::SOLVE_BATCH || !(packet >> count)) {
+        error = "Unexpected reply";
+        return false;
+    }
+    replies.resize(count);
+    for (sf::Uint32 i = 0; i < count; ++i)
+    {
+        if (!(packet >> replies[i])) {
+            error = "Truncated SOLVE_BATCH reply";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runClientLoad(SolveClient & client, const std::vector<SolveProtocol::Request>& requests, unsigned int batchSize,
+    unsigned int pipelineDepth, ClientRunStats & stats, std::ostream * csv, std::string & error)
+{
+    typedef std::chrono::steady_clock Clock;
+    batchSize = std::max(batchSize, 1U);
+    pipelineDepth = std::max(pipelineDepth, 1U);
+
+    stats = ClientRunStats{ 0, 0, 0, 0.0, 0.0, 0.0 };
+    std::unordered_map<sf::Uint32, Clock::time_point> sentAt; // First requestId of a batch -> send time
+    std::vector<double> latencies;
+    std::vector<SolveProtocol::Request> batch;
+    std::vector<SolveProtocol::Reply> replies;
+    size_t next = 0;
+    unsigned int inFlight = 0;
+
+    if (csv)
+        *csv << "request_id,status,length,expanded\n";
+
+    auto begin = Clock::now();
+    while (next < requests.size() || inFlight > 0)
+    {
+        // Fill the pipeline, then wait for one reply
+        if (next < requests.size() && inFlight < pipelineDepth) {
+            size_t last = std::min(next + batchSize, requests.size());
+            batch.assign(requests.begin() + next, requests.begin() + last);
+            sentAt[batch.front().requestId] = Clock::now();
+            if (!client.sendBatch(batch, error))
+                return false;
+            next = last;
+            ++inFlight;
+            continue;
+        }
+
+        sf::Uint32 rejectedId = SolveProtocol::NO_REQUEST_ID;
+        if (!client.receiveBatch(replies, rejectedId, error))
+            return false;
+        --inFlight;
+
+        if (rejectedId != SolveProtocol::NO_REQUEST_ID) {
+            sentAt.erase(rejectedId);
+            ++stats.rejectedBatches;
+            error = "Batch at request " + std::to_string(rejectedId) + " rejected, " + error;
+            continue;
+        }
+
+        if (!replies.empty()) {
+            auto it = sentAt.find(replies.front().requestId);
+            if (it != sentAt.end()) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - it->second).count());
+                sentAt.erase(it);
+            }
+        }
+        for (const SolveProtocol::Reply& reply : replies)
+        {
+            ++stats.requests;
+            if (reply.status == SolveProtocol::STATUS_FOUND)
+                ++stats.found;
+            if (csv)
+                *csv << reply.requestId << ',' << static_cast<unsigned int>(reply.status) << ',' << reply.length << ',' << reply.expanded << '\n';
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        stats.batchLatencyP50 = latencies[latencies.size() / 2];
+        stats.batchLatencyP99 = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+    }
+    return true;
+}
@@ -0,0 +1,54 @@
+#ifndef SOLVE_CLIENT_H
+#define SOLVE_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <SFML/Network.hpp>
+
+#include "solve_protocol.h"
+
+/*
+    Local test client for SolveServer.
+
+    mazefinder client [--host 127.0.0.1] [--port P] [--maze ID] [--algo astar]
+                      [--queries q.txt | --count N --seed S] [--batch B] [--pipeline D] [--out replies.csv]
+
+    Random queries are drawn inside the maze bounds reported by MAZE_INFO, so some land on walls and come back
+    as STATUS_NO_PATH, which is fine for load testing.  Up to D batches are kept in flight on one connection.
+*/
+
+class SolveClient
+{
+private:
+    sf::TcpSocket socket;
+
+public:
+    bool connect(const std::string& host, unsigned short port, std::string& error);
+
+    // rows / cols of every maze on the server
+    bool mazeInfo(std::vector<std::pair<unsigned int, unsigned int>>& sizes, std::string& error);
+
+    bool sendBatch(const std::vector<SolveProtocol::Request>& requests, std::string& error);
+    // False when the connection is no use any more.  A batch the server rejected comes back as true with
+    // replies empty, rejectedId set to the batch's first requestId and error holding the server's message
+    bool receiveBatch(std::vector<SolveProtocol::Reply>& replies, sf::Uint32& rejectedId, std::string& error);
+};
+
+struct ClientRunStats
+{
+    unsigned long long requests;
+    unsigned long long found;
+    unsigned long long rejectedBatches; // Refused with an ERROR reply, their requests aren't counted
+    double seconds;
+    double batchLatencyP50; // Microseconds, send to reply
+    double batchLatencyP99;
+};
+
+// Sends requests in batches with up to pipelineDepth batches in flight.  Replies go to csv when it's not null.
+// A rejected batch doesn't stop the run, error ends up with the last rejection message
+bool runClientLoad(SolveClient& client, const std::vector<SolveProtocol::Request>& requests, unsigned int batchSize,
+    unsigned int pipelineDepth, ClientRunStats& stats, std::ostream * csv, std::string& error);
+
+#endif // !SOLVE_CLIENT_H
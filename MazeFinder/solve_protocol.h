@@ -0,0 +1,79 @@
+#ifndef SOLVE_PROTOCOL_H
+#define SOLVE_PROTOCOL_H
+
+#include <SFML/Network.hpp>
+
+/*
+    Wire format between SolveServer and its clients.  Every message is one sf::Packet, so on the wire it is
+    a 4 byte big-endian payload length followed by the payload.  All integers are big-endian.
+
+    Request payload:
+        Uint8 type
+        SOLVE_BATCH:  Uint32 count, then count x { Uint32 requestId, Uint32 mazeId,
+                      Uint32 startRow, Uint32 startCol, Uint32 endRow, Uint32 endCol, Uint8 algo }
+        MAZE_INFO:    nothing
+
+    Response payload:
+        Uint8 type
+        SOLVE_BATCH:  Uint32 count, then count x { Uint32 requestId, Uint8 status, Uint32 length, Uint32 expanded }
+        MAZE_INFO:    Uint32 mazeCount, then mazeCount x { Uint32 rows, Uint32 cols }
+        ERROR:        Uint32 requestId, std::string message (Uint32 length + bytes)
+                      requestId is the first one of the rejected batch, NO_REQUEST_ID when the server couldn't read one
+
+    Clients may pipeline: send many batches without waiting.  Batches can finish out of order,
+    requestId is what ties a reply to its request.  algo is the Algorithm enum value (0 bfs, 1 dfs, 2 astar).
+*/
+
+namespace SolveProtocol {
+
+    const unsigned short DEFAULT_PORT = 47000;
+    const std::size_t REQUEST_BYTES = 6 * 4 + 1; // One Request on the wire
+    const sf::Uint32 NO_REQUEST_ID = 0xFFFFFFFF; // ERROR reply not tied to a batch
+
+    enum e_messageType { SOLVE_BATCH = 0, MAZE_INFO = 1, ERROR_REPLY = 2 };
+    enum e_status { STATUS_FOUND = 0, STATUS_NO_PATH = 1, STATUS_BAD_MAZE = 2, STATUS_BAD_REQUEST = 3 };
+
+    struct Request
+    {
+        sf::Uint32 requestId;
+        sf::Uint32 mazeId;
+        sf::Uint32 startRow;
+        sf::Uint32 startCol;
+        sf::Uint32 endRow;
+        sf::Uint32 endCol;
+        sf::Uint8 algo;
+    };
+
+    struct Reply
+    {
+        sf::Uint32 requestId;
+        sf::Uint8 status;
+        sf::Uint32 length;
+        sf::Uint32 expanded;
+    };
+
+    inline sf::Packet& operator << (sf::Packet& packet, const Request& request)
+    {
+        return packet << request.requestId << request.mazeId << request.startRow << request.startCol <<
+            request.endRow << request.endCol << request.algo;
+    }
+
+    inline sf::Packet& operator >> (sf::Packet& packet, Request& request)
+    {
+        return packet >> request.requestId >> request.mazeId >> request.startRow >> request.startCol >>
+            request.endRow >> request.endCol >> request.algo;
+    }
+
+    inline sf::Packet& operator << (sf::Packet& packet, const Reply& reply)
+    {
+        return packet << reply.requestId << reply.status << reply.length << reply.expanded;
+    }
+
+    inline sf::Packet& operator >> (sf::Packet& packet, Reply& reply)
+    {
+        return packet >> reply.requestId >> reply.status >> reply.length >> reply.expanded;
+    }
+
+}  // namespace
+
+#endif // !SOLVE_PROTOCOL_H
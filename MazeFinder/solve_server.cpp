@@ -0,0 +1,370 @@
+#include "solve_server.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace {
+
+    const size_t CHUNK_SIZE = 64; // Requests per pool task
+    const sf::Uint32 MAX_BATCH = 1 << 20;
+    const sf::Time IDLE_WAIT = sf::milliseconds(100); // Only bounds how long stop() takes to be noticed
+    const sf::Time SEND_RETRY_WAIT = sf::milliseconds(1); // A socket buffer was full, the selector can't tell when it empties
+    const std::size_t RECEIVE_CHUNK = 64 * 1024;
+    const std::size_t LENGTH_BYTES = 4; // sf::Packet frame header, big-endian payload length
+
+    std::size_t frameLength(const char * header)
+    {
+        const unsigned char * bytes = reinterpret_cast<const unsigned char *>(header);
+        return (static_cast<std::size_t>(bytes[0]) << 24) | (static_cast<std::size_t>(bytes[1]) << 16) |
+            (static_cast<std::size_t>(bytes[2]) << 8) | bytes[3];
+    }
+
+}  // namespace
+
+const std::size_t SolveServer::MAX_PACKET_BYTES = sizeof(sf::Uint8) + sizeof(sf::Uint32) + MAX_BATCH * SolveProtocol::REQUEST_BYTES;
+const std::size_t SolveServer::MAX_OUTBOX_BYTES;
+const unsigned int SolveServer::MAX_REQUESTS_IN_FLIGHT;
+
+SolveServer::SolveServer(std::vector<Maze>&& mazes, unsigned int threadCount, std::size_t cacheBytes)
+    : mazes(std::move(mazes)), pool(threadCount), contexts(pool.size()), wakePending(false), stopRequested(false), solvedCount(0)
+{
+    if (cacheBytes > 0)
+        cache.reset(new PathCache(cacheBytes));
+}
+
+bool SolveServer::start(unsigned short port, const std::string & bindAddress, std::string & error)
+{
+    sf::IpAddress address(bindAddress);
+    if (address == sf::IpAddress::None) {
+        error = "Bad bind address " + bindAddress;
+        return false;
+    }
+    if (listener.listen(port, address) != sf::Socket::Done) {
+        error = "Could not listen on " + bindAddress + ":" + std::to_string(port);
+        return false;
+    }
+    if (wakeSocket.bind(sf::Socket::AnyPort, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+        error = "Could not bind the loopback wake socket";
+        return false;
+    }
+    wakeSocket.setBlocking(false);
+    notifySocket.setBlocking(false);
+    selector.add(listener);
+    selector.add(wakeSocket);
+    return true;
+}
+
+void SolveServer::stop()
+{
+    stopRequested = true;
+}
+
+void SolveServer::wake()
+{
+    if (wakePending.exchange(true))
+        return;
+    char byte = 0;
+    if (notifySocket.send(&byte, 1, sf::IpAddress::LocalHost, wakeSocket.getLocalPort()) != sf::Socket::Done)
+        wakePending = false; // Lost, the next reply tries again.  IDLE_WAIT still bounds the delay
+}
+
+void SolveServer::run()
+{
+    bool sendBlocked = false;
+    while (!stopRequested)
+    {
+        if (selector.wait(sendBlocked ? SEND_RETRY_WAIT : IDLE_WAIT))
+        {
+            if (selector.isReady(wakeSocket)) {
+                // Cleared before the flush below, so a reply queued after it sends another byte
+                char bytes[64];
+                std::size_t received = 0;
+                sf::IpAddress sender;
+                unsigned short port = 0;
+                while (wakeSocket.receive(bytes, sizeof(bytes), received, sender, port) == sf::Socket::Done)
+                {
+                }
+                wakePending = false;
+            }
+
+            if (selector.isReady(listener))
+                acceptConnection();
+
+            for (size_t i = 0; i < connections.size(); )
+            {
+                if (!connections[i]->paused && selector.isReady(connections[i]->socket) && !receiveFrom(connections[i])) {
+                    closeConnection(i);
+                    continue;
+                }
+                ++i;
+            }
+        }
+        sendBlocked = flushOutboxes();
+        resumeDrained();
+    }
+
+    // Let in flight batches finish before the connections go away
+    pool.wait();
+    flushOutboxes();
+    for (size_t i = connections.size(); i-- > 0; )
+        closeConnection(i);
+    listener.close();
+}
+
+void SolveServer::acceptConnection()
+{
+    std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+    if (listener.accept(connection->socket) != sf::Socket::Done)
+        return;
+
+    connection->socket.setBlocking(false);
+    selector.add(connection->socket);
+    connections.push_back(connection);
+}
+
+bool SolveServer::receiveFrom(const std::shared_ptr<Connection>& connection)
+{
+    // Drain everything that already arrived, a pipelining client may have sent several batches.
+    // Stops early when it has too much queued, the rest waits in the socket until it is resumed
+    char buffer[RECEIVE_CHUNK];
+    while (true)
+    {
+        if (!handleInbox(connection))
+            return false;
+        if (connection->paused)
+            return true;
+
+        std::size_t received = 0;
+        sf::Socket::Status status = connection->socket.receive(buffer, sizeof(buffer), received);
+        if (status == sf::Socket::NotReady)
+            return true;
+        if (status != sf::Socket::Done)
+            return false;
+        connection->inbox.insert(connection->inbox.end(), buffer, buffer + received);
+    }
+}
+
+bool SolveServer::handleInbox(const std::shared_ptr<Connection>& connection)
+{
+    std::vector<char>& inbox = connection->inbox;
+    std::size_t used = 0;
+    bool ok = true;
+    while (inbox.size() - used >= LENGTH_BYTES)
+    {
+        // Checked on the header, before the payload is waited for
+        std::size_t length = frameLength(&inbox[used]);
+        if (length > MAX_PACKET_BYTES) {
+            ok = false;
+            break;
+        }
+        if (inbox.size() - used - LENGTH_BYTES < length)
+            break;
+        if (isBacklogged(*connection)) {
+            connection->paused = true;
+            selector.remove(connection->socket);
+            break;
+        }
+
+        sf::Packet packet;
+        packet.append(inbox.data() + used + LENGTH_BYTES, length);
+        used += LENGTH_BYTES + length;
+        handlePacket(connection, packet);
+    }
+    inbox.erase(inbox.begin(), inbox.begin() + used);
+    return ok;
+}
+
+void SolveServer::handlePacket(const std::shared_ptr<Connection>& connection, sf::Packet & packet)
+{
+    sf::Uint8 type = 0;
+    if (!(packet >> type))
+        return;
+
+    if (type == SolveProtocol::SOLVE_BATCH)
+        handleSolveBatch(connection, packet);
+    else if (type == SolveProtocol::MAZE_INFO)
+        handleMazeInfo(connection);
+    else
+        queueError(*connection, SolveProtocol::NO_REQUEST_ID, "Unknown message type");
+}
+
+void SolveServer::handleSolveBatch(const std::shared_ptr<Connection>& connection, sf::Packet & packet)
+{
+    std::shared_ptr<PendingBatch> batch = std::make_shared<PendingBatch>();
+    batch->connection = connection;
+
+    // Count is checked against what actually arrived before anything is sized from it
+    sf::Uint32 count = 0;
+    bool ok = static_cast<bool>(packet >> count) && count <= MAX_BATCH
+        && packet.getDataSize() >= sizeof(sf::Uint8) + sizeof(sf::Uint32) + count * SolveProtocol::REQUEST_BYTES;
+    if (ok) {
+        batch->requests.resize(count);
+        for (sf::Uint32 i = 0; i < count && ok; ++i)
+            ok = static_cast<bool>(packet >> batch->requests[i]);
+    }
+    if (!ok) {
+        // The client tracks a batch by its first requestId, so echo that when it got far enough to read it
+        sf::Uint32 requestId = SolveProtocol::NO_REQUEST_ID;
+        if (!batch->requests.empty())
+            requestId = batch->requests[0].requestId;
+        else if (!(packet >> requestId))
+            requestId = SolveProtocol::NO_REQUEST_ID;
+        queueError(*connection, requestId, "Malformed SOLVE_BATCH");
+        return;
+    }
+
+    batch->replies.resize(count);
+    if (count == 0) {
+        sf::Packet reply;
+        reply << static_cast<sf::Uint8>(SolveProtocol::SOLVE_BATCH) << static_cast<sf::Uint32>(0);
+        queueReply(*connection, reply);
+        return;
+    }
+
+    connection->requestsInFlight += count;
+    size_t chunks = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    batch->chunksLeft = static_cast<unsigned int>(chunks);
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        size_t first = i * CHUNK_SIZE;
+        size_t last = std::min<size_t>(first + CHUNK_SIZE, count);
+        pool.enqueue([this, batch, first, last](unsigned int worker) { solveChunk(batch, first, last, contexts[worker]); });
+    }
+}
+
+void SolveServer::handleMazeInfo(const std::shared_ptr<Connection>& connection)
+{
+    sf::Packet reply;
+    reply << static_cast<sf::Uint8>(SolveProtocol::MAZE_INFO) << static_cast<sf::Uint32>(mazes.size());
+    for (const Maze& maze : mazes)
+        reply << static_cast<sf::Uint32>(maze.getRows()) << static_cast<sf::Uint32>(maze.getCols());
+    queueReply(*connection, reply);
+}
+
+void SolveServer::solveChunk(const std::shared_ptr<PendingBatch>& batch, size_t first, size_t last, SearchContext & context)
+{
+    for (size_t i = first; i < last; ++i)
+    {
+        const SolveProtocol::Request& request = batch->requests[i];
+        SolveProtocol::Reply& reply = batch->replies[i];
+        reply.requestId = request.requestId;
+        reply.length = 0;
+        reply.expanded = 0;
+
+        if (request.mazeId >= mazes.size()) {
+            reply.status = SolveProtocol::STATUS_BAD_MAZE;
+            continue;
+        }
+        const Maze& maze = mazes[request.mazeId];
+        if (!maze.inBounds(request.startRow, request.startCol) || !maze.inBounds(request.endRow, request.endCol)
+            || request.algo > static_cast<sf::Uint8>(Algorithm::AStar)) {
+            reply.status = SolveProtocol::STATUS_BAD_REQUEST;
+            continue;
+        }
+
+        SolveResult result = solveCached(cache.get(), maze, context, static_cast<Algorithm>(request.algo),
+            maze.index(request.startRow, request.startCol), maze.index(request.endRow, request.endCol));
+        reply.status = result.found ? SolveProtocol::STATUS_FOUND : SolveProtocol::STATUS_NO_PATH;
+        reply.length = result.pathLength;
+        reply.expanded = result.expanded;
+    }
+    solvedCount += last - first;
+
+    // Last chunk out builds the reply
+    if (--batch->chunksLeft != 0)
+        return;
+    batch->connection->requestsInFlight -= static_cast<unsigned int>(batch->requests.size());
+    if (batch->connection->closed)
+        return;
+
+    sf::Packet packet;
+    packet << static_cast<sf::Uint8>(SolveProtocol::SOLVE_BATCH) << static_cast<sf::Uint32>(batch->replies.size());
+    for (const SolveProtocol::Reply& reply : batch->replies)
+        packet << reply;
+    queueReply(*batch->connection, packet);
+}
+
+void SolveServer::queueReply(Connection & connection, sf::Packet & packet)
+{
+    {
+        std::lock_guard<std::mutex> lock(connection.outboxMutex);
+        connection.outboxBytes += packet.getDataSize();
+        connection.outbox.push_back(packet);
+    }
+    wake();
+}
+
+void SolveServer::queueError(Connection & connection, sf::Uint32 requestId, const std::string & message)
+{
+    sf::Packet reply;
+    reply << static_cast<sf::Uint8>(SolveProtocol::ERROR_REPLY) << requestId << message;
+    queueReply(connection, reply);
+}
+
+bool SolveServer::isBacklogged(Connection & connection)
+{
+    std::lock_guard<std::mutex> lock(connection.outboxMutex);
+    return connection.outboxBytes >= MAX_OUTBOX_BYTES || connection.requestsInFlight >= MAX_REQUESTS_IN_FLIGHT;
+}
+
+void SolveServer::resumeDrained()
+{
+    for (size_t i = 0; i < connections.size(); )
+    {
+        std::shared_ptr<Connection>& connection = connections[i];
+        if (connection->paused && !isBacklogged(*connection)) {
+            // Packets already in the inbox go now, the selector only reports what's still in the socket
+            connection->paused = false;
+            selector.add(connection->socket);
+            if (!receiveFrom(connection)) {
+                closeConnection(i);
+                continue;
+            }
+        }
+        ++i;
+    }
+}
+
+bool SolveServer::flushOutboxes()
+{
+    bool blocked = false;
+    for (size_t i = 0; i < connections.size(); )
+    {
+        Connection& connection = *connections[i];
+        bool failed = false;
+        {
+            std::lock_guard<std::mutex> lock(connection.outboxMutex);
+            while (!connection.outbox.empty())
+            {
+                // A Partial send keeps its position inside the packet, so retry the same one next time
+                sf::Socket::Status status = connection.socket.send(connection.outbox.front());
+                if (status == sf::Socket::Done) {
+                    connection.outboxBytes -= connection.outbox.front().getDataSize();
+                    connection.outbox.pop_front();
+                }
+                else {
+                    failed = (status == sf::Socket::Disconnected || status == sf::Socket::Error);
+                    blocked = !failed;
+                    break;
+                }
+            }
+        }
+
+        if (failed) {
+            closeConnection(i);
+            continue;
+        }
+        ++i;
+    }
+    return blocked;
+}
+
+void SolveServer::closeConnection(size_t index)
+{
+    std::shared_ptr<Connection> connection = connections[index];
+    connection->closed = true;
+    if (!connection->paused)
+        selector.remove(connection->socket);
+    connection->socket.disconnect();
+    connections.erase(connections.begin() + index);
+}
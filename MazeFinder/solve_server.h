@@ -0,0 +1,110 @@
+#ifndef SOLVE_SERVER_H
+#define SOLVE_SERVER_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstddef>
+
+#include <SFML/Network.hpp>
+
+#include "maze.h"
+#include "solver.h"
+#include "thread_pool.h"
+#include "solve_protocol.h"
+#include "path_cache.h"
+#include "search_context.h"
+
+/*
+    Long running solve server.  Keeps its mazes resident and answers SolveProtocol requests over TCP.
+
+    mazefinder serve [--load a.txt,b.txt] [--mazes K --size N --seed S] [--port P] [--threads T] [--bind 127.0.0.1]
+                     [--cache-mb M]
+
+    The main thread owns every socket (accept, receive, send).  Each SOLVE_BATCH is cut into chunks
+    that run on the ThreadPool, and the last chunk to finish queues the reply on its connection's outbox.
+    The main thread drains outboxes between selector waits, so one slow client never blocks a worker.
+    Queueing a reply sends a byte to a loopback UDP socket in the selector, so an idle server sleeps
+    in the selector instead of polling for finished batches.
+
+    Frames are cut out of each connection's inbox here instead of with socket.receive(sf::Packet&), so a declared
+    length above MAX_PACKET_BYTES drops the connection before any of it is buffered.
+
+    A client that sends faster than it reads gets paused: once its unsent replies pass MAX_OUTBOX_BYTES,
+    or its batches still being solved pass MAX_REQUESTS_IN_FLIGHT requests, its socket leaves the selector
+    until that drains.  TCP flow control then pushes back on the client.
+*/
+
+class SolveServer
+{
+private:
+    struct Connection
+    {
+        sf::TcpSocket socket;
+        std::mutex outboxMutex;
+        std::vector<char> inbox; // Received, not cut into packets yet.  Main thread only
+        std::deque<sf::Packet> outbox; // Front may be partially sent
+        std::size_t outboxBytes; // Under outboxMutex
+        std::atomic<unsigned int> requestsInFlight; // Accepted, reply not queued yet
+        std::atomic<bool> closed;
+        bool paused; // Out of the selector until its backlog drains.  Main thread only
+
+        Connection() : outboxBytes(0), requestsInFlight(0), closed(false), paused(false) {}
+    };
+
+    struct PendingBatch
+    {
+        std::shared_ptr<Connection> connection;
+        std::vector<SolveProtocol::Request> requests;
+        std::vector<SolveProtocol::Reply> replies;
+        std::atomic<unsigned int> chunksLeft;
+    };
+
+    std::vector<Maze> mazes; // Read only while serving, id = index
+    std::unique_ptr<PathCache> cache; // Null when caching is off.  Mazes are keyed by hash, so duplicates share entries
+    ThreadPool pool;
+    std::vector<SearchContext> contexts; // One per pool worker
+    sf::TcpListener listener;
+    sf::SocketSelector selector;
+    sf::UdpSocket wakeSocket; // In the selector, bound to loopback
+    sf::UdpSocket notifySocket; // Workers send wake bytes from this
+    std::atomic<bool> wakePending; // A wake byte is on its way, no need for another
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::atomic<bool> stopRequested;
+    std::atomic<unsigned long long> solvedCount;
+
+    void acceptConnection();
+    bool receiveFrom(const std::shared_ptr<Connection>& connection); // False when the client went away or broke the framing
+    bool handleInbox(const std::shared_ptr<Connection>& connection); // Handles every complete packet, pauses when backlogged
+    void handlePacket(const std::shared_ptr<Connection>& connection, sf::Packet& packet);
+    void handleSolveBatch(const std::shared_ptr<Connection>& connection, sf::Packet& packet);
+    void handleMazeInfo(const std::shared_ptr<Connection>& connection);
+    void queueReply(Connection& connection, sf::Packet& packet);
+    void queueError(Connection& connection, sf::Uint32 requestId, const std::string& message);
+    void solveChunk(const std::shared_ptr<PendingBatch>& batch, size_t first, size_t last, SearchContext& context);
+    bool flushOutboxes(); // True when some socket couldn't take everything
+    bool isBacklogged(Connection& connection);
+    void resumeDrained(); // Puts paused connections back in the selector once they drained
+    void wake(); // Any thread
+    void closeConnection(size_t index);
+
+public:
+    static const std::size_t MAX_PACKET_BYTES; // Biggest SOLVE_BATCH the server accepts, larger frames drop the connection
+    static const std::size_t MAX_OUTBOX_BYTES = 64 << 20; // Unsent replies per connection before it's paused
+    static const unsigned int MAX_REQUESTS_IN_FLIGHT = 1 << 21; // Requests being solved per connection before it's paused
+
+    //Constructor
+    SolveServer(std::vector<Maze>&& mazes, unsigned int threadCount, std::size_t cacheBytes = 0);
+
+    bool start(unsigned short port, const std::string& bindAddress, std::string& error);
+    void run(); // Serves until stop()
+    void stop(); // Safe from another thread or a signal handler
+
+    unsigned long long getSolvedCount() const { return solvedCount.load(); }
+    const PathCache * getCache() const { return cache.get(); }
+};
+
+#endif // !SOLVE_SERVER_H
@@ -0,0 +1,348 @@
+#include "solver.h"
+#include "search_context.h"
+#include "probes.h"
+
+#include <climits>
+#include <algorithm>
+
+namespace {
+
+    // Open 4-neighbors of cell in left, bottom, right, top order (same as Graph::SearchBFSNeighbors)
+    unsigned int getNeighbors(const Maze& maze, unsigned int cell, unsigned int neighbors[4])
+    {
+        unsigned int row = maze.rowOf(cell);
+        unsigned int col = maze.colOf(cell);
+        unsigned int count = 0;
+
+        if (col > 0 && maze.isPath(cell - 1))
+            neighbors[count++] = cell - 1;
+        if (row + 1 < maze.getRows() && maze.isPath(cell + maze.getCols()))
+            neighbors[count++] = cell + maze.getCols();
+        if (col + 1 < maze.getCols() && maze.isPath(cell + 1))
+            neighbors[count++] = cell + 1;
+        if (row > 0 && maze.isPath(cell - maze.getCols()))
+            neighbors[count++] = cell - maze.getCols();
+        return count;
+    }
+
+    unsigned int absDiff(unsigned int valueOne, unsigned int valueTwo)
+    {
+        return valueOne > valueTwo ? valueOne - valueTwo : valueTwo - valueOne;
+    }
+
+    unsigned int manhattan(const Maze& maze, unsigned int from, unsigned int to)
+    {
+        return absDiff(maze.rowOf(from), maze.rowOf(to)) + absDiff(maze.colOf(from), maze.colOf(to));
+    }
+
+    // Walks parents back from end.  Returns the number of moves and fills path if asked
+    unsigned int createPath(const SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+    {
+        unsigned int length = 0;
+        if (path)
+            path->clear();
+
+        for (unsigned int cell = end; ; cell = context.getParent(cell)) {
+            if (path)
+                path->push_back(cell);
+            if (cell == start)
+                break;
+            ++length;
+        }
+
+        if (path)
+            std::reverse(path->begin(), path->end());
+        return length;
+    }
+
+    // Shared argument checks.  Returns true when the query can't possibly succeed
+    bool isTrivialFailure(const Maze& maze, unsigned int start, unsigned int end)
+    {
+        return start >= maze.cellCount() || end >= maze.cellCount() || maze.isWall(start) || maze.isWall(end);
+    }
+
+}  // namespace
+
+bool parseAlgorithm(const std::string & name, Algorithm & algo)
+{
+    if (name == "bfs")
+        algo = Algorithm::BFS;
+    else if (name == "dfs")
+        algo = Algorithm::DFS;
+    else if (name == "astar" || name == "a*")
+        algo = Algorithm::AStar;
+    else
+        return false;
+    return true;
+}
+
+const char * algorithmName(Algorithm algo)
+{
+    switch (algo) {
+    case Algorithm::BFS:
+        return "bfs";
+    case Algorithm::DFS:
+        return "dfs";
+    case Algorithm::AStar:
+        return "astar";
+    }
+    return "unknown";
+}
+
+bool MinHeap::lessThan(const HeapNode & a, const HeapNode & b)
+{
+    // Lowest f cost first, ties go to the lowest h cost (closest to end)
+    if (a.f_cost != b.f_cost)
+        return a.f_cost < b.f_cost;
+    return a.h_cost < b.h_cost;
+}
+
+void MinHeap::heapInsert(const HeapNode & node)
+{
+    heap.push_back(node);
+    unsigned int index = heap.size() - 1;
+    MAZE_PROBE1(heap__insert, heap.size());
+
+    // This loop climbs up to the top!
+    while (index != 0 && lessThan(heap[index], heap[getParent(index)]))
+    {
+        std::swap(heap[index], heap[getParent(index)]);
+        index = getParent(index);
+    }
+}
+
+void MinHeap::MinHeapify(unsigned int index)
+{
+    // Iterative sift down so huge open lists can't blow the stack
+    while (true)
+    {
+        unsigned int leftChildIndex = getLeftChild(index);
+        unsigned int rightChildIndex = getRightChild(index);
+        unsigned int smallest = index;
+
+        if (leftChildIndex < heap.size() && lessThan(heap[leftChildIndex], heap[smallest]))
+            smallest = leftChildIndex;
+        if (rightChildIndex < heap.size() && lessThan(heap[rightChildIndex], heap[smallest]))
+            smallest = rightChildIndex;
+
+        if (smallest == index)
+            break;
+        std::swap(heap[index], heap[smallest]);
+        index = smallest;
+    }
+}
+
+bool MinHeap::heapExtractMin(HeapNode & node)
+{
+    MAZE_PROBE1(heap__extract, heap.size());
+    if (heap.empty())
+        return false;
+
+    node = heap[0];
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (!heap.empty())
+        MinHeapify(0);
+    return true;
+}
+
+void MinHeap::heapReplaceMin(const HeapNode & node)
+{
+    heap[0] = node;
+    MinHeapify(0);
+}
+
+SolveResult solveBFS(const Maze & maze, SearchContext & context, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SolveResult result = { false, 0, 0 };
+    if (isTrivialFailure(maze, start, end))
+        return result;
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_BFS, maze.rowOf(start), maze.colOf(start));
+
+    context.begin(maze.cellCount());
+    std::vector<unsigned int>& bfsQueue = context.frontier;
+    bfsQueue.push_back(start);
+    context.setVisited(start);
+    context.setParent(start, start);
+    context.setDistance(start, 0);
+
+    unsigned int neighbors[4];
+    for (size_t head = 0; head < bfsQueue.size() && !result.found; ++head)
+    {
+        unsigned int currentNode = bfsQueue[head];
+        ++result.expanded;
+        MAZE_PROBE2(node__expand, maze.rowOf(currentNode), maze.colOf(currentNode));
+
+        if (currentNode == end) {
+            result.found = true;
+            break;
+        }
+
+        unsigned int count = getNeighbors(maze, currentNode, neighbors);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (!context.isVisited(neighbors[i])) {
+                context.setVisited(neighbors[i]);
+                context.setParent(neighbors[i], currentNode);
+                context.setDistance(neighbors[i], context.getDistance(currentNode) + 1);
+                bfsQueue.push_back(neighbors[i]);
+            }
+        }
+    }
+
+    if (result.found)
+        result.pathLength = createPath(context, start, end, path);
+
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_BFS, result.found, result.pathLength);
+    return result;
+}
+
+SolveResult solveDFS(const Maze & maze, SearchContext & context, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SolveResult result = { false, 0, 0 };
+    if (isTrivialFailure(maze, start, end))
+        return result;
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_DFS, maze.rowOf(start), maze.colOf(start));
+
+    // Explicit stack instead of Graph::DFSrecurse() so big mazes can't overflow the call stack.
+    // Each entry remembers which neighbor it tries next, and cells are marked when they are entered,
+    // so cells get the same parents as the recursion.  It stops at end, the recursion's answer is fixed by then
+    context.begin(maze.cellCount());
+    std::vector<unsigned int>& dfsStack = context.frontier;
+    std::vector<unsigned char>& nextNeighbor = context.nextNeighbor;
+    dfsStack.push_back(start);
+    nextNeighbor.push_back(0);
+    context.setVisited(start);
+    context.setParent(start, start);
+    ++result.expanded;
+    MAZE_PROBE2(node__expand, maze.rowOf(start), maze.colOf(start));
+    result.found = start == end;
+
+    unsigned int neighbors[4];
+    while (!dfsStack.empty() && !result.found)
+    {
+        unsigned int currentNode = dfsStack.back();
+        unsigned int count = getNeighbors(maze, currentNode, neighbors);
+        unsigned int i = nextNeighbor.back();
+        while (i < count && context.isVisited(neighbors[i]))
+            ++i;
+        if (i == count) {
+            dfsStack.pop_back();
+            nextNeighbor.pop_back();
+            continue;
+        }
+        nextNeighbor.back() = static_cast<unsigned char>(i + 1);
+
+        unsigned int neighbor = neighbors[i];
+        context.setVisited(neighbor);
+        context.setParent(neighbor, currentNode);
+        ++result.expanded;
+        MAZE_PROBE2(node__expand, maze.rowOf(neighbor), maze.colOf(neighbor));
+        if (neighbor == end) {
+            result.found = true;
+            break;
+        }
+        dfsStack.push_back(neighbor);
+        nextNeighbor.push_back(0);
+    }
+
+    if (result.found)
+        result.pathLength = createPath(context, start, end, path);
+
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_DFS, result.found, result.pathLength);
+    return result;
+}
+
+SolveResult solveAStar(const Maze & maze, SearchContext & context, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SolveResult result = { false, 0, 0 };
+    if (isTrivialFailure(maze, start, end))
+        return result;
+
+    MAZE_PROBE3(solve__start, MAZE_PROBE_ALGO_ASTAR, maze.rowOf(start), maze.colOf(start));
+
+    // visited = closed, distance = g cost
+    context.begin(maze.cellCount());
+    MinHeap& priorityQueue = context.open;
+
+    context.setDistance(start, 0);
+    context.setParent(start, start);
+    unsigned int h = manhattan(maze, start, end);
+    priorityQueue.heapInsert({ h, h, start });
+
+    HeapNode current;
+    unsigned int neighbors[4];
+    while (priorityQueue.heapExtractMin(current))
+    {
+        // Stale entry, a cheaper copy was already expanded
+        if (context.isVisited(current.cell))
+            continue;
+        context.setVisited(current.cell);
+        ++result.expanded;
+        MAZE_PROBE2(node__expand, maze.rowOf(current.cell), maze.colOf(current.cell));
+
+        if (current.cell == end) {
+            result.found = true;
+            break;
+        }
+
+        unsigned int count = getNeighbors(maze, current.cell, neighbors);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            unsigned int next = neighbors[i];
+            unsigned int temp_g_cost = context.getDistance(current.cell) + 1; // No diagonals, so this "1" is constant
+            if (context.isVisited(next) || temp_g_cost >= context.getDistance(next))
+                continue;
+
+            context.setDistance(next, temp_g_cost);
+            context.setParent(next, current.cell);
+            h = manhattan(maze, next, end);
+            priorityQueue.heapInsert({ temp_g_cost + h, h, next });
+        }
+    }
+
+    if (result.found)
+        result.pathLength = createPath(context, start, end, path);
+
+    MAZE_PROBE3(solve__end, MAZE_PROBE_ALGO_ASTAR, result.found, result.pathLength);
+    return result;
+}
+
+SolveResult solve(const Maze & maze, SearchContext & context, Algorithm algo, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    switch (algo) {
+    case Algorithm::BFS:
+        return solveBFS(maze, context, start, end, path);
+    case Algorithm::DFS:
+        return solveDFS(maze, context, start, end, path);
+    case Algorithm::AStar:
+        return solveAStar(maze, context, start, end, path);
+    }
+    return SolveResult{ false, 0, 0 };
+}
+
+SolveResult solveBFS(const Maze & maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SearchContext context;
+    return solveBFS(maze, context, start, end, path);
+}
+
+SolveResult solveDFS(const Maze & maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SearchContext context;
+    return solveDFS(maze, context, start, end, path);
+}
+
+SolveResult solveAStar(const Maze & maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SearchContext context;
+    return solveAStar(maze, context, start, end, path);
+}
+
+SolveResult solve(const Maze & maze, Algorithm algo, unsigned int start, unsigned int end, std::vector<unsigned int> * path)
+{
+    SearchContext context;
+    return solve(maze, context, algo, start, end, path);
+}
@@ -0,0 +1,76 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <vector>
+#include <string>
+
+#include "maze.h"
+
+// Headless versions of Graph's BFS, DFS and A*.  No rendering, no logging.
+// Cells are Maze indices.  Moves are 4-connected with unit cost, like the GUI.
+
+enum class Algorithm { BFS, DFS, AStar };
+
+bool parseAlgorithm(const std::string& name, Algorithm& algo); // "bfs", "dfs", "astar"
+const char * algorithmName(Algorithm algo);
+
+// One "start -> end" query, cells are Maze indices
+struct Query
+{
+    unsigned int start;
+    unsigned int end;
+};
+
+struct SolveResult
+{
+    bool found;
+    unsigned int pathLength; // Moves from start to end.  Shortest for BFS and A*, DFS returns whatever it walked
+    unsigned int expanded; // Nodes taken off the queue / stack / heap
+};
+
+// Open list for A*.  Same primitives as Graph's heap, ordered by f_cost then h_cost
+struct HeapNode
+{
+    unsigned int f_cost;
+    unsigned int h_cost;
+    unsigned int cell;
+};
+
+class MinHeap
+{
+private:
+    std::vector<HeapNode> heap;
+
+    static bool lessThan(const HeapNode& a, const HeapNode& b);
+
+public:
+    unsigned int getLeftChild(const unsigned int& index) const { return index * 2 + 1; }
+    unsigned int getRightChild(const unsigned int& index) const { return index * 2 + 2; }
+    unsigned int getParent(const unsigned int& index) const { return (index - 1) / 2; }
+
+    void heapInsert(const HeapNode& node);
+    void MinHeapify(unsigned int index);
+    bool heapExtractMin(HeapNode& node); // False when empty
+    void heapReplaceMin(const HeapNode& node); // Overwrites the top and sifts it down.  Heap must not be empty
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    void clear() { heap.clear(); }
+    void reserve(size_t count) { heap.reserve(count); }
+};
+
+class SearchContext; // search_context.h
+
+// Path (start..end inclusive) is written to path when it is not null and the end was found.
+// The SearchContext versions only read the maze, so threads with their own context can share one Maze
+SolveResult solveBFS(const Maze& maze, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solveDFS(const Maze& maze, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solveAStar(const Maze& maze, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solve(const Maze& maze, SearchContext& context, Algorithm algo, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+
+// One-off queries, a fresh context each call
+SolveResult solveBFS(const Maze& maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solveDFS(const Maze& maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solveAStar(const Maze& maze, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+SolveResult solve(const Maze& maze, Algorithm algo, unsigned int start, unsigned int end, std::vector<unsigned int> * path = nullptr);
+
+#endif // !SOLVER_H
@@ -0,0 +1,68 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    busyWorkers = 0;
+    stopping = false;
+
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        stopping = true;
+    }
+    taskReady.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void ThreadPool::enqueue(std::function<void(unsigned int)> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.push(std::move(task));
+    }
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(taskMutex);
+    allDone.wait(lock, [this] { return tasks.empty() && busyWorkers == 0; });
+}
+
+void ThreadPool::workerLoop(unsigned int workerIndex)
+{
+    while (true)
+    {
+        std::function<void(unsigned int)> task;
+        {
+            std::unique_lock<std::mutex> lock(taskMutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) // Only when stopping
+                return;
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++busyWorkers;
+        }
+
+        task(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            --busyWorkers;
+            if (tasks.empty() && busyWorkers == 0)
+                allDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed size worker pool.  Tasks get the index of the worker running them (0..size()-1)
+// so callers can keep per-worker scratch without locking.
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void(unsigned int)>> tasks;
+
+    std::mutex taskMutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    unsigned int busyWorkers;
+    bool stopping;
+
+    void workerLoop(unsigned int workerIndex);
+
+public:
+    //Constructor and Destructor
+    explicit ThreadPool(unsigned int threadCount = 0); // 0 = one per hardware thread
+    ~ThreadPool();
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+
+    void enqueue(std::function<void(unsigned int)> task);
+    void wait(); // Blocks until the queue is empty and every worker is idle
+
+    // Make it Non Copyable
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator= (const ThreadPool &) = delete;
+};
+#endif // !THREAD_POOL_H
@@ -0,0 +1,29 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+/*
+    Zobrist hashing for wall layouts.  The hash of a maze is zobristBase(rows, cols) XORed with
+    zobristKey(cell) for every wall cell, so toggling one wall is a single XOR.
+    Keys come from splitmix64 of the cell index instead of a table, an 8192 x 8192 table would be 512MB.
+*/
+
+inline unsigned long long zobristMix(unsigned long long value)
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+inline unsigned long long zobristKey(unsigned int cell)
+{
+    return zobristMix(cell);
+}
+
+// Hash of an all path maze.  Mazes of different sizes never share a hash by accident of having no walls
+inline unsigned long long zobristBase(unsigned int rows, unsigned int cols)
+{
+    return zobristMix(((static_cast<unsigned long long>(rows) << 32) | cols) ^ 0x5a0b7157ULL) ^ 0xd6e8feb86659fd93ULL;
+}
+
+#endif // !ZOBRIST_H